@@ -0,0 +1,145 @@
+#include "ofApp.h"
+
+//--------------------------------------------------------------
+void ofApp::setup(){
+  scene = make_shared<ofxWebcamSyntheticScene>();
+  scene->setup(CHECK_CAMERAS * 640, 480, CHECK_PEOPLE);
+
+  shared_ptr<ofxWebcamArray> array = make_shared<ofxWebcamArray>();
+  for(int i=0; i<CHECK_CAMERAS; i++)
+  {
+    array->addSource(make_shared<ofxWebcamSyntheticSource>(scene, ofVec2f(i * 640, 0), DEFAULT_SYNTHETIC_NOISE, i + 1), 640, 480);
+  }
+  generic.init(array);
+  compiled.init(array);
+  generic.setPipelineVariant(OFX_WEBCAM_PIPELINE_GENERIC);
+
+  key = 0;
+  frame = 0;
+  failedKeys = 0;
+  genericTotal = 0;
+  compiledTotal = 0;
+}
+
+//--------------------------------------------------------------
+void ofApp::update(){
+  if(frame == 0)
+  {
+    configure(generic, key);
+    configure(compiled, key);
+    compiled.setPipelineVariant(key);
+    mismatches = 0;
+    wrongKeys = 0;
+    genericMillis = 0;
+    compiledMillis = 0;
+  }
+
+  scene->advance();
+  generic.update();
+  compiled.update();
+
+  //The first frame of each key only gives the background.
+  if(frame == 0)
+  {
+    generic.grabBackground();
+    compiled.grabBackground();
+    generic.setBackgroundSubtract(key & OFX_WEBCAM_PIPELINE_SUBTRACT);
+    compiled.setBackgroundSubtract(key & OFX_WEBCAM_PIPELINE_SUBTRACT);
+  }
+  else
+  {
+    if(!compare()) mismatches++;
+    if(compiled.getPipelineKey() != key) wrongKeys++;
+    genericMillis += generic.getSegmentTime();
+    compiledMillis += compiled.getSegmentTime();
+  }
+
+  frame++;
+  if(frame == CHECK_FRAMES_PER_KEY)
+  {
+    report();
+    frame = 0;
+    key++;
+    if(key == OFX_WEBCAM_PIPELINE_VARIANTS)
+    {
+      ofLogNotice("ofApp") << "all instances: generic " << genericTotal << " ms, compiled " << compiledTotal << " ms";
+      if(failedKeys > 0)
+      {
+        ofLogError("ofApp") << failedKeys << " of " << OFX_WEBCAM_PIPELINE_VARIANTS << " instances differ from the generic pipeline";
+      }
+      else
+      {
+        ofLogNotice("ofApp") << "every instance matches the generic pipeline";
+      }
+      ofExit();
+    }
+  }
+}
+
+//--------------------------------------------------------------
+void ofApp::draw(){
+
+}
+
+//Settings that make the tracker pick the instance for variant. Contours are
+//asked for so the packed mask is only used when the key says so.
+void ofApp::configure(ofxWebcamTracker & tracker, int variant){
+  tracker.setLatencyTarget(0);
+  tracker.setBlobAttributes(OFX_WEBCAM_BLOB_BOUNDS | OFX_WEBCAM_BLOB_CONTOUR);
+  tracker.setBlur(variant & OFX_WEBCAM_PIPELINE_BLUR);
+  tracker.setPackedMask(variant & OFX_WEBCAM_PIPELINE_PACKED);
+  tracker.setAdaptiveThreshold(variant & OFX_WEBCAM_PIPELINE_ADAPTIVE);
+  tracker.setShadowSuppression(variant & OFX_WEBCAM_PIPELINE_SHADOWS);
+  tracker.setMorphology((variant & OFX_WEBCAM_PIPELINE_CLEAN) ? OFX_WEBCAM_MORPHOLOGY_OPEN_CLOSE : OFX_WEBCAM_MORPHOLOGY_NONE);
+}
+
+//Same mask, and the same blobs in the same places.
+bool ofApp::compare(){
+  if(key & OFX_WEBCAM_PIPELINE_SUBTRACT)
+  {
+    ofPixels & a = generic.getDiffPixels();
+    ofPixels & b = compiled.getDiffPixels();
+    if(a.size() != b.size() || memcmp(a.getData(), b.getData(), a.size()) != 0) return false;
+  }
+
+  if(generic.blobs.size() != compiled.blobs.size()) return false;
+  for(size_t i=0; i<generic.blobs.size(); i++)
+  {
+    ofxCvBlob & a = generic.blobs[i].blob;
+    ofxCvBlob & b = compiled.blobs[i].blob;
+    if(generic.blobs[i].id != compiled.blobs[i].id) return false;
+    if(a.centroid.x != b.centroid.x || a.centroid.y != b.centroid.y || a.area != b.area) return false;
+    if(a.boundingRect.x != b.boundingRect.x || a.boundingRect.y != b.boundingRect.y ||
+       a.boundingRect.width != b.boundingRect.width || a.boundingRect.height != b.boundingRect.height) return false;
+  }
+  return true;
+}
+
+void ofApp::report(){
+  int frames = CHECK_FRAMES_PER_KEY - 1;
+  bool ok = mismatches == 0 && wrongKeys == 0;
+  if(!ok) failedKeys++;
+  genericTotal += genericMillis;
+  compiledTotal += compiledMillis;
+
+  ofLogNotice("ofApp") << "key " << key << " (" << describe(key) << "): generic " << genericMillis / frames << " ms, compiled " << compiledMillis / frames << " ms per frame";
+  if(mismatches > 0)
+  {
+    ofLogError("ofApp") << "key " << key << ": " << mismatches << " of " << frames << " frames differ";
+  }
+  if(wrongKeys > 0)
+  {
+    ofLogError("ofApp") << "key " << key << ": another instance ran in " << wrongKeys << " frames";
+  }
+}
+
+string ofApp::describe(int variant){
+  string stages;
+  if(variant & OFX_WEBCAM_PIPELINE_BLUR) stages += "blur ";
+  if(variant & OFX_WEBCAM_PIPELINE_SUBTRACT) stages += "subtract ";
+  if(variant & OFX_WEBCAM_PIPELINE_PACKED) stages += "packed ";
+  if(variant & OFX_WEBCAM_PIPELINE_ADAPTIVE) stages += "adaptive ";
+  if(variant & OFX_WEBCAM_PIPELINE_SHADOWS) stages += "shadows ";
+  if(variant & OFX_WEBCAM_PIPELINE_CLEAN) stages += "clean ";
+  return stages.empty() ? "nothing" : stages.substr(0, stages.size() - 1);
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "ofMain.h"
+#include "ofxWebcamTracker.h"
+#include "ofxWebcamSyntheticScene.h"
+
+#define CHECK_CAMERAS 2
+#define CHECK_PEOPLE 8
+#define CHECK_FRAMES_PER_KEY 30
+
+//Runs every compiled segmentation instance on a synthetic scene next to
+//the generic pipeline, which checks each setting as it goes. Both trackers
+//share the cameras, so they see the same frames; their masks and blobs
+//have to be the same. Logs how long each took per frame.
+class ofApp : public ofBaseApp{
+
+	public:
+		void setup();
+		void update();
+		void draw();
+
+		void configure(ofxWebcamTracker & tracker, int variant);
+		bool compare();
+		void report();
+		string describe(int variant);
+
+		shared_ptr<ofxWebcamSyntheticScene> scene;
+		ofxWebcamTracker generic;
+		ofxWebcamTracker compiled;
+
+		int key;
+		int frame;
+		int mismatches;
+		int wrongKeys;
+		float genericMillis;
+		float compiledMillis;
+		int failedKeys;
+		float genericTotal;
+		float compiledTotal;
+};
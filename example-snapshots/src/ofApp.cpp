@@ -0,0 +1,113 @@
+#include "ofApp.h"
+
+//--------------------------------------------------------------
+void ofApp::setup(){
+  scene = make_shared<ofxWebcamSyntheticScene>();
+  scene->setup(STRESS_CAMERAS * 640, 480, STRESS_PEOPLE);
+
+  shared_ptr<ofxWebcamArray> array = make_shared<ofxWebcamArray>();
+  for(int i=0; i<STRESS_CAMERAS; i++)
+  {
+    array->addSource(make_shared<ofxWebcamSyntheticSource>(scene, ofVec2f(i * 640, 0), DEFAULT_SYNTHETIC_NOISE, i + 1), 640, 480);
+  }
+  tracker.init(array);
+  tracker.startThread();
+
+  reading = true;
+  reads = 0;
+  interpolations = 0;
+  errors = 0;
+  for(int i=0; i<STRESS_READERS; i++)
+  {
+    readers.push_back(std::thread(&ofApp::read, this, i));
+  }
+}
+
+//--------------------------------------------------------------
+void ofApp::update(){
+  scene->advance();
+  tracker.update();
+
+  if(scene->getFrameNumber() >= STRESS_FRAMES)
+  {
+    stopReaders();
+    tracker.stopThread();
+
+    ofxWebcamSnapshotRef last = tracker.getSnapshot();
+    ofLogNotice("ofApp") << STRESS_FRAMES << " frames, " << (last.isValid() ? last->frame : 0) << " processed, " << tracker.getSkippedSnapshots() << " snapshots skipped";
+    ofLogNotice("ofApp") << STRESS_READERS << " readers, " << reads << " snapshots read, " << interpolations << " interpolated reads";
+    if(errors > 0)
+    {
+      ofLogError("ofApp") << errors << " inconsistent snapshots";
+    }
+    else
+    {
+      ofLogNotice("ofApp") << "every snapshot was consistent";
+    }
+    ofExit();
+  }
+}
+
+//--------------------------------------------------------------
+void ofApp::draw(){
+
+}
+
+//--------------------------------------------------------------
+void ofApp::exit(){
+  stopReaders();
+  tracker.stopThread();
+}
+
+//Takes snapshots in a loop and checks each one on its own and against the
+//one before. Every few reads it also asks where the blobs were a frame ago.
+void ofApp::read(int reader){
+  float interval = 1.0f / scene->getFrameRate();
+  uint64_t lastFrame = 0;
+  float lastTime = 0;
+  vector<int> ids;
+  vector<ofxWebcamSnapshotBlob> interpolated;
+  uint64_t count = 0;
+
+  while(reading)
+  {
+    {
+      ofxWebcamSnapshotRef snapshot = tracker.getSnapshot();
+      if(!snapshot.isValid()) continue;
+
+      bool ok = snapshot->frame >= lastFrame && snapshot->captureTime >= lastTime;
+      ids.clear();
+      for(size_t i=0; i<snapshot->blobs.size(); i++)
+      {
+        const ofxWebcamSnapshotBlob & blob = snapshot->blobs[i];
+        ok = ok && blob.time <= snapshot->captureTime && blob.area >= 0;
+        ids.push_back(blob.id);
+      }
+      std::sort(ids.begin(), ids.end());
+      ok = ok && std::adjacent_find(ids.begin(), ids.end()) == ids.end();
+      if(!ok)
+      {
+        errors++;
+        ofLogError("ofApp") << "Reader " << reader << " got an inconsistent snapshot of frame " << snapshot->frame;
+      }
+      lastFrame = snapshot->frame;
+      lastTime = snapshot->captureTime;
+    }
+
+    if(++count % 8 == 0)
+    {
+      tracker.getBlobsAt(lastTime - interval, interpolated);
+      interpolations++;
+    }
+    reads++;
+  }
+}
+
+void ofApp::stopReaders(){
+  reading = false;
+  for(size_t i=0; i<readers.size(); i++)
+  {
+    readers[i].join();
+  }
+  readers.clear();
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "ofMain.h"
+#include "ofxWebcamTracker.h"
+#include "ofxWebcamSyntheticScene.h"
+
+#define STRESS_CAMERAS 2
+#define STRESS_PEOPLE 12
+#define STRESS_READERS 4
+#define STRESS_FRAMES 3000
+
+//The tracker publishes snapshots from its own thread while several reader
+//threads take them as fast as they can. Readers check every snapshot they
+//get is whole and never older than the one before. Meant to be built with
+//ThreadSanitizer (see config.make).
+class ofApp : public ofBaseApp{
+
+	public:
+		void setup();
+		void update();
+		void draw();
+		void exit();
+
+		void read(int reader);
+		void stopReaders();
+
+		shared_ptr<ofxWebcamSyntheticScene> scene;
+		ofxWebcamTracker tracker;
+
+		vector<std::thread> readers;
+		std::atomic<bool> reading;
+		std::atomic<uint64_t> reads;
+		std::atomic<uint64_t> interpolations;
+		std::atomic<int> errors;
+};
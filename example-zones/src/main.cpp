@@ -0,0 +1,12 @@
+#include "ofMain.h"
+#include "ofApp.h"
+#include "ofAppNoWindow.h"
+
+//========================================================================
+int main( ){
+	//Nothing is drawn, the results are logged.
+	ofAppNoWindow window;
+	ofSetupOpenGL(&window, 1024,768, OF_WINDOW);
+	ofRunApp(new ofApp());
+
+}
@@ -0,0 +1,180 @@
+#include "ofApp.h"
+
+static float sideOf(const ofVec2f & a, const ofVec2f & b, const ofVec2f & p)
+{
+  return (b.x - a.x) * (p.y - a.y) - (b.y - a.y) * (p.x - a.x);
+}
+
+static bool containsPoint(const vector<ofVec2f> & pts, const ofVec2f & p)
+{
+  bool in = false;
+  for(size_t i=0, j=pts.size() - 1; i<pts.size(); j=i++)
+  {
+    if((pts[i].y > p.y) != (pts[j].y > p.y) &&
+       p.x < pts[j].x + (pts[i].x - pts[j].x) * (p.y - pts[j].y) / (pts[i].y - pts[j].y))
+    {
+      in = !in;
+    }
+  }
+  return in;
+}
+
+//--------------------------------------------------------------
+void ofApp::setup(){
+  ofSeedRandom(1);
+  zones.setup(BENCHMARK_WIDTH, BENCHMARK_HEIGHT);
+
+  //Small quads and short lines all over the image, like a shop floor
+  //divided into shelves and doorways.
+  for(int i=0; i<BENCHMARK_ZONES; i++)
+  {
+    float x = ofRandom(BENCHMARK_WIDTH - 80);
+    float y = ofRandom(BENCHMARK_HEIGHT - 40);
+    vector<ofVec2f> points;
+    points.push_back(ofVec2f(x, y));
+    points.push_back(ofVec2f(x + ofRandom(5, 45), y + 3));
+    points.push_back(ofVec2f(x + 30, y + ofRandom(5, 45)));
+    points.push_back(ofVec2f(x - 5, y + 30));
+    zones.addZone(points);
+  }
+  for(int i=0; i<BENCHMARK_TRIPWIRES; i++)
+  {
+    ofVec2f a(ofRandom(BENCHMARK_WIDTH - 80), ofRandom(BENCHMARK_HEIGHT - 40));
+    zones.addTripwire(a, a + ofVec2f(ofRandom(-30, 30), ofRandom(-30, 30)));
+  }
+
+  ofxCvBlob blob;
+  for(int i=0; i<BENCHMARK_BLOBS; i++)
+  {
+    blob.centroid = ofPoint(ofRandom(BENCHMARK_WIDTH), ofRandom(BENCHMARK_HEIGHT));
+    blobs.push_back(ofxWebcamBlob(i, blob, 1, 0));
+    positions.push_back(ofVec2f(blob.centroid.x, blob.centroid.y));
+  }
+
+  inside.assign(BENCHMARK_BLOBS, vector<bool>(BENCHMARK_ZONES, false));
+  occupancy.assign(BENCHMARK_ZONES, 0);
+  entries = 0;
+  exits = 0;
+  forward = 0;
+  backward = 0;
+  gridMillis = 0;
+  bruteMillis = 0;
+  evaluated = 0;
+  frame = 0;
+}
+
+//--------------------------------------------------------------
+void ofApp::update(){
+  if(frame > 0)
+  {
+    moveBlobs();
+  }
+
+  uint64_t start = ofGetElapsedTimeMicros();
+  events.clear();
+  zones.update(blobs, frame / 30.0f, frame, events);
+  gridMillis += (ofGetElapsedTimeMicros() - start) / 1000.0;
+  evaluated += zones.getEvaluated();
+
+  start = ofGetElapsedTimeMicros();
+  countAll();
+  bruteMillis += (ofGetElapsedTimeMicros() - start) / 1000.0;
+
+  frame++;
+  if(frame == BENCHMARK_FRAMES)
+  {
+    report();
+    ofExit();
+  }
+}
+
+//--------------------------------------------------------------
+void ofApp::draw(){
+
+}
+
+//Two out of three blobs wander a few pixels each frame, the rest stand still.
+void ofApp::moveBlobs(){
+  for(size_t i=0; i<blobs.size(); i++)
+  {
+    if(i % 3 == 0) continue;
+    ofPoint & c = blobs[i].blob.centroid;
+    c.x = ofClamp(c.x + ofRandom(-4, 4), 0, BENCHMARK_WIDTH - 1);
+    c.y = ofClamp(c.y + ofRandom(-4, 4), 0, BENCHMARK_HEIGHT - 1);
+  }
+}
+
+//Every blob against every zone and tripwire.
+void ofApp::countAll(){
+  vector<ofxWebcamZone> & allZones = zones.getZones();
+  vector<ofxWebcamTripwire> & allWires = zones.getTripwires();
+  for(size_t i=0; i<blobs.size(); i++)
+  {
+    ofVec2f from = positions[i];
+    ofVec2f to(blobs[i].blob.centroid.x, blobs[i].blob.centroid.y);
+
+    for(size_t z=0; z<allZones.size(); z++)
+    {
+      bool in = containsPoint(allZones[z].points, to);
+      if(in && !inside[i][z])
+      {
+        entries++;
+        occupancy[z]++;
+      }
+      else if(!in && inside[i][z])
+      {
+        exits++;
+        occupancy[z]--;
+      }
+      inside[i][z] = in;
+    }
+
+    if(frame == 0 || (from.x == to.x && from.y == to.y)) continue;
+    for(size_t w=0; w<allWires.size(); w++)
+    {
+      ofxWebcamTripwire & wire = allWires[w];
+      float s0 = sideOf(wire.a, wire.b, from);
+      float s1 = sideOf(wire.a, wire.b, to);
+      if((s0 < 0) == (s1 < 0)) continue;
+      if((sideOf(from, to, wire.a) < 0) == (sideOf(from, to, wire.b) < 0)) continue;
+      if(s1 < 0) forward++;
+      else backward++;
+    }
+    positions[i] = to;
+  }
+}
+
+void ofApp::report(){
+  int gridEntries = 0;
+  int gridExits = 0;
+  int gridForward = 0;
+  int gridBackward = 0;
+  int wrongZones = 0;
+  vector<ofxWebcamZone> & allZones = zones.getZones();
+  for(size_t z=0; z<allZones.size(); z++)
+  {
+    gridEntries += allZones[z].entries;
+    gridExits += allZones[z].exits;
+    if(allZones[z].occupancy != occupancy[z]) wrongZones++;
+  }
+  vector<ofxWebcamTripwire> & allWires = zones.getTripwires();
+  for(size_t w=0; w<allWires.size(); w++)
+  {
+    gridForward += allWires[w].forward;
+    gridBackward += allWires[w].backward;
+  }
+
+  bool same = wrongZones == 0 && gridEntries == entries && gridExits == exits && gridForward == forward && gridBackward == backward;
+  ofLogNotice("ofApp") << BENCHMARK_ZONES << " zones, " << BENCHMARK_TRIPWIRES << " tripwires, " << BENCHMARK_BLOBS << " blobs, " << BENCHMARK_FRAMES << " frames";
+  ofLogNotice("ofApp") << "grid: " << gridMillis / BENCHMARK_FRAMES << " ms per frame, " << evaluated / (float)BENCHMARK_FRAMES << " blobs evaluated";
+  ofLogNotice("ofApp") << "every zone: " << bruteMillis / BENCHMARK_FRAMES << " ms per frame";
+  ofLogNotice("ofApp") << "entries " << gridEntries << "/" << entries << ", exits " << gridExits << "/" << exits << ", forward " << gridForward << "/" << forward << ", backward " << gridBackward << "/" << backward;
+  if(same)
+  {
+    ofLogNotice("ofApp") << "counts match";
+  }
+  else
+  {
+    ofLogError("ofApp") << "counts differ, " << wrongZones << " zones with the wrong occupancy";
+  }
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "ofMain.h"
+#include "ofxWebcamZones.h"
+
+#define BENCHMARK_WIDTH 1280
+#define BENCHMARK_HEIGHT 480
+#define BENCHMARK_ZONES 400
+#define BENCHMARK_TRIPWIRES 150
+#define BENCHMARK_BLOBS 300
+#define BENCHMARK_FRAMES 600
+
+//Times ofxWebcamZones with hundreds of zones, tripwires and blobs against
+//testing every blob against every zone and line, and checks that both
+//count the same.
+class ofApp : public ofBaseApp{
+
+	public:
+		void setup();
+		void update();
+		void draw();
+
+		void moveBlobs();
+		void countAll();
+		void report();
+
+		ofxWebcamZones zones;
+		vector<ofxWebcamBlob> blobs;
+		vector<ofxWebcamZoneEvent> events;
+		int frame;
+
+		//Brute force counts
+		vector<ofVec2f> positions;
+		vector<vector<bool> > inside;
+		vector<int> occupancy;
+		int entries;
+		int exits;
+		int forward;
+		int backward;
+
+		double gridMillis;
+		double bruteMillis;
+		int evaluated;
+};
@@ -0,0 +1,296 @@
+#include "ofxWebcamAdaptiveThreshold.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+ofxWebcamAdaptiveThreshold::ofxWebcamAdaptiveThreshold() : width(0), height(0), numRegions(0) {
+  minThreshold = 1;
+  maxThreshold = DEFAULT_ADAPTIVE_MAX_THRESHOLD;
+  gain = DEFAULT_ADAPTIVE_GAIN;
+  rate = DEFAULT_ADAPTIVE_RATE;
+  sampleStep = DEFAULT_ADAPTIVE_SAMPLE_STEP;
+}
+
+ofxWebcamAdaptiveThreshold::~ofxWebcamAdaptiveThreshold(){
+
+}
+
+//Splits every camera rectangle in tilesX by tilesY regions. Where cameras
+//overlap the last one wins; pixels outside every camera get a region of
+//their own that always keeps the minimum threshold.
+void ofxWebcamAdaptiveThreshold::setup(int width, int height, const vector<ofRectangle> & cameras, int tilesX, int tilesY)
+{
+  this->width = width;
+  this->height = height;
+  tilesX = MAX(1, tilesX);
+  tilesY = MAX(1, tilesY);
+
+  regions.clear();
+  for(size_t c=0; c<cameras.size(); c++)
+  {
+    const ofRectangle & r = cameras[c];
+    for(int ty=0; ty<tilesY; ty++)
+    {
+      for(int tx=0; tx<tilesX; tx++)
+      {
+        regions.push_back(ofRectangle(r.x + r.width * tx / tilesX, r.y + r.height * ty / tilesY, r.width / tilesX, r.height / tilesY));
+      }
+    }
+  }
+  numRegions = regions.size();
+  uint16_t outside = numRegions;
+
+  rowBand.assign(height, 0);
+  regionLines.clear();
+  vector<uint16_t> line(width);
+  for(int y=0; y<height; y++)
+  {
+    std::fill(line.begin(), line.end(), outside);
+    for(int i=0; i<numRegions; i++)
+    {
+      ofRectangle & r = regions[i];
+      if(y < (int)floor(r.y) || y >= (int)ceil(r.y + r.height)) continue;
+      int x0 = MAX(0, (int)floor(r.x));
+      int x1 = MIN(width, (int)ceil(r.x + r.width));
+      for(int x=x0; x<x1; x++) line[x] = i;
+    }
+
+    if(regionLines.empty() || regionLines.back() != line)
+    {
+      regionLines.push_back(line);
+    }
+    rowBand[y] = regionLines.size() - 1;
+  }
+
+  limitLines.assign(regionLines.size(), vector<unsigned char>(width));
+  histograms.assign((size_t)(numRegions + 1) * 4 * 256, 0);
+  reset();
+}
+
+bool ofxWebcamAdaptiveThreshold::isAllocated()
+{
+  return width > 0 && !rowBand.empty();
+}
+
+//Starts every region again from the minimum threshold.
+void ofxWebcamAdaptiveThreshold::reset()
+{
+  thresholds.assign(numRegions + 1, minThreshold);
+  std::fill(histograms.begin(), histograms.end(), 0);
+  refreshLimits();
+}
+
+void ofxWebcamAdaptiveThreshold::setMinThreshold(float value)
+{
+  if(value == minThreshold) return;
+  minThreshold = ofClamp(value, 0, 255);
+  for(size_t i=0; i<thresholds.size(); i++)
+  {
+    thresholds[i] = MAX(thresholds[i], minThreshold);
+  }
+  if(!thresholds.empty())
+  {
+    thresholds.back() = minThreshold;
+  }
+  refreshLimits();
+}
+
+void ofxWebcamAdaptiveThreshold::setMaxThreshold(float value)
+{
+  maxThreshold = ofClamp(value, 0, 255);
+}
+
+void ofxWebcamAdaptiveThreshold::setGain(float value)
+{
+  gain = MAX(0, value);
+}
+
+//How far each threshold moves towards its target every frame.
+void ofxWebcamAdaptiveThreshold::setRate(float value)
+{
+  rate = ofClamp(value, 0, 1);
+}
+
+//Only every n-th row is counted in the histograms.
+void ofxWebcamAdaptiveThreshold::setSampleStep(int rows)
+{
+  sampleStep = MAX(1, rows);
+}
+
+float ofxWebcamAdaptiveThreshold::getGain()
+{
+  return gain;
+}
+
+void ofxWebcamAdaptiveThreshold::refreshLimits()
+{
+  if(thresholds.empty()) return;
+
+  vector<unsigned char> limits(thresholds.size());
+  for(size_t i=0; i<thresholds.size(); i++)
+  {
+    limits[i] = (unsigned char)ceil(ofClamp(thresholds[i], 0, 255));
+  }
+
+  for(size_t b=0; b<regionLines.size(); b++)
+  {
+    vector<uint16_t> & regionLine = regionLines[b];
+    vector<unsigned char> & limitLine = limitLines[b];
+    for(int x=0; x<width; x++)
+    {
+      limitLine[x] = limits[regionLine[x]];
+    }
+  }
+}
+
+//Moves each threshold towards gain times the noise of its region. For
+//normal noise the median absolute difference is 0.6745 sigma.
+void ofxWebcamAdaptiveThreshold::update()
+{
+  for(int r=0; r<numRegions; r++)
+  {
+    uint32_t * h = &histograms[(size_t)r * 4 * 256];
+    uint64_t total = 0;
+    uint32_t counts[256];
+    for(int v=0; v<256; v++)
+    {
+      counts[v] = h[v] + h[256 + v] + h[512 + v] + h[768 + v];
+      total += counts[v];
+    }
+    if(total < 64) continue;
+
+    double half = total / 2.0;
+    double below = 0;
+    float median = 0;
+    for(int v=0; v<256; v++)
+    {
+      if(below + counts[v] >= half)
+      {
+        median = MAX(0.0, v - 0.5 + (half - below) / counts[v]);
+        break;
+      }
+      below += counts[v];
+    }
+
+    float target = ofClamp(gain * 1.4826 * median, minThreshold, MAX(minThreshold, maxThreshold));
+    thresholds[r] += rate * (target - thresholds[r]);
+  }
+
+  std::fill(histograms.begin(), histograms.end(), 0);
+  refreshLimits();
+}
+
+template<bool Packed>
+void ofxWebcamAdaptiveThreshold::pass(const ofPixels & image, const ofPixels & reference, ofxWebcamBinaryMask * mask, ofPixels * out)
+{
+  const unsigned char * a = image.getData();
+  const unsigned char * b = reference.getData();
+  uint32_t * hist = &histograms[0];
+
+  for(int y=0; y<height; y++)
+  {
+    const unsigned char * la = a + (size_t)y * width;
+    const unsigned char * lb = b + (size_t)y * width;
+    const unsigned char * limits = &limitLines[rowBand[y]][0];
+    const uint16_t * regionLine = &regionLines[rowBand[y]][0];
+    bool sampled = y % sampleStep == 0;
+    uint64_t * row = Packed ? mask->getRow(y) : NULL;
+    unsigned char * dst = Packed ? NULL : out->getData() + (size_t)y * width;
+    uint64_t word = 0;
+    int x = 0;
+
+#if defined(__SSE2__)
+    const __m128i zero = _mm_setzero_si128();
+    unsigned char values[16];
+    for(; x + 16 <= width; x += 16)
+    {
+      __m128i va = _mm_loadu_si128((const __m128i *)(la + x));
+      __m128i vb = _mm_loadu_si128((const __m128i *)(lb + x));
+      __m128i vl = _mm_loadu_si128((const __m128i *)(limits + x));
+      __m128i d = _mm_or_si128(_mm_subs_epu8(va, vb), _mm_subs_epu8(vb, va));
+      //d >= limit exactly when limit - d saturates to 0
+      __m128i foreground = _mm_cmpeq_epi8(_mm_subs_epu8(vl, d), zero);
+
+      if(Packed)
+      {
+        word |= (uint64_t)_mm_movemask_epi8(foreground) << (x & 63);
+        if((x & 63) == 48)
+        {
+          row[x >> 6] = word;
+          word = 0;
+        }
+      }
+      else
+      {
+        _mm_storeu_si128((__m128i *)(dst + x), foreground);
+      }
+
+      if(sampled)
+      {
+        _mm_storeu_si128((__m128i *)values, d);
+        for(int k=0; k<16; k++)
+        {
+          hist[((size_t)regionLine[x + k] * 4 + (k & 3)) * 256 + values[k]]++;
+        }
+      }
+    }
+#endif
+
+    for(; x < width; x++)
+    {
+      int d = abs(la[x] - lb[x]);
+      bool foreground = d >= limits[x];
+      if(Packed)
+      {
+        if(foreground) word |= 1ULL << (x & 63);
+        if((x & 63) == 63)
+        {
+          row[x >> 6] = word;
+          word = 0;
+        }
+      }
+      else
+      {
+        dst[x] = foreground ? 255 : 0;
+      }
+
+      if(sampled)
+      {
+        hist[((size_t)regionLine[x] * 4 + (x & 3)) * 256 + d]++;
+      }
+    }
+
+    if(Packed && (width & 63) != 0)
+    {
+      row[width >> 6] = word;
+    }
+  }
+
+  update();
+}
+
+void ofxWebcamAdaptiveThreshold::apply(const ofPixels & image, const ofPixels & reference, ofxWebcamBinaryMask & mask)
+{
+  if(mask.getWidth() != width || mask.getHeight() != height)
+  {
+    mask.allocate(width, height);
+  }
+  pass<true>(image, reference, &mask, NULL);
+}
+
+void ofxWebcamAdaptiveThreshold::apply(const ofPixels & image, const ofPixels & reference, ofPixels & out)
+{
+  pass<false>(image, reference, NULL, &out);
+}
+
+vector<ofRectangle> & ofxWebcamAdaptiveThreshold::getRegions()
+{
+  return regions;
+}
+
+//One threshold per region, plus a last one for pixels outside all cameras.
+vector<float> & ofxWebcamAdaptiveThreshold::getThresholds()
+{
+  return thresholds;
+}
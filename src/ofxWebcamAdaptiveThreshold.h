@@ -0,0 +1,62 @@
+#pragma once
+#include "ofMain.h"
+#include "ofxWebcamBinaryMask.h"
+
+#define DEFAULT_ADAPTIVE_GAIN 4.0
+#define DEFAULT_ADAPTIVE_MAX_THRESHOLD 80
+#define DEFAULT_ADAPTIVE_RATE 0.05
+#define DEFAULT_ADAPTIVE_SAMPLE_STEP 2
+
+//Thresholds the difference to the background with a separate threshold for
+//each camera, or each tile of a camera. While thresholding, the pass also
+//counts a histogram of the difference values in every region. The median
+//of that histogram is a robust estimate of the region's noise, and each
+//threshold follows gain times that noise, never going below the minimum.
+class ofxWebcamAdaptiveThreshold {
+  private:
+    int width;
+    int height;
+    int numRegions;
+    vector<ofRectangle> regions;
+    vector<float> thresholds;
+
+    //Rows with the same layout of regions share one band.
+    vector<int> rowBand;
+    vector<vector<uint16_t> > regionLines;
+    vector<vector<unsigned char> > limitLines;
+
+    //Four histograms per region, one per pixel lane, so consecutive
+    //pixels do not wait on each other's increment.
+    vector<uint32_t> histograms;
+
+    float minThreshold;
+    float maxThreshold;
+    float gain;
+    float rate;
+    int sampleStep;
+
+    void refreshLimits();
+    void update();
+    template<bool Packed> void pass(const ofPixels & image, const ofPixels & reference, ofxWebcamBinaryMask * mask, ofPixels * out);
+
+  public:
+    ofxWebcamAdaptiveThreshold();
+    ~ofxWebcamAdaptiveThreshold();
+
+    void setup(int width, int height, const vector<ofRectangle> & cameras, int tilesX=1, int tilesY=1);
+    bool isAllocated();
+    void reset();
+
+    void setMinThreshold(float value);
+    void setMaxThreshold(float value);
+    void setGain(float value);
+    void setRate(float value);
+    void setSampleStep(int rows);
+    float getGain();
+
+    void apply(const ofPixels & image, const ofPixels & reference, ofxWebcamBinaryMask & mask);
+    void apply(const ofPixels & image, const ofPixels & reference, ofPixels & out);
+
+    vector<ofRectangle> & getRegions();
+    vector<float> & getThresholds();
+};
@@ -0,0 +1,258 @@
+#include "ofxWebcamAppearance.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+static inline int ctz64(uint64_t v) { unsigned long i; _BitScanForward64(&i, v); return (int)i; }
+#else
+static inline int ctz64(uint64_t v) { return __builtin_ctzll(v); }
+#endif
+
+static inline int binOf(const unsigned char * p)
+{
+  return ((p[0] >> 6) << 4) | ((p[1] >> 6) << 2) | (p[2] >> 6);
+}
+
+ofxWebcamAppearance::ofxWebcamAppearance(){
+  clear();
+}
+
+void ofxWebcamAppearance::clear()
+{
+  memset(bins, 0, sizeof(bins));
+  valid = false;
+}
+
+void ofxWebcamAppearance::finish(size_t pixels)
+{
+  if(pixels < APPEARANCE_MIN_PIXELS)
+  {
+    clear();
+    return;
+  }
+
+  //No bin can pass 255, even when the whole blob is one color.
+  float scale = 255.0f / pixels;
+  for(int i=0; i<APPEARANCE_BINS; i++)
+  {
+    bins[i] = (uint8_t)(counts[i] * scale + 0.5f);
+  }
+  valid = true;
+}
+
+//Foreground pixels of rect from the packed mask. Every other row is enough.
+void ofxWebcamAppearance::compute(const ofPixels & rgb, const ofRectangle & rect, ofxWebcamBinaryMask & mask)
+{
+  int width = mask.getWidth();
+  if(rgb.getNumChannels() < 3 || (int)rgb.getWidth() != width || (int)rgb.getHeight() != mask.getHeight())
+  {
+    clear();
+    return;
+  }
+
+  int x0 = MAX(0, (int)rect.x);
+  int y0 = MAX(0, (int)rect.y);
+  int x1 = MIN(width, (int)ceil(rect.x + rect.width));
+  int y1 = MIN(mask.getHeight(), (int)ceil(rect.y + rect.height));
+  int channels = rgb.getNumChannels();
+  const unsigned char * in = rgb.getData();
+
+  memset(counts, 0, sizeof(counts));
+  size_t pixels = 0;
+  for(int y=y0; y<y1; y+=2)
+  {
+    const uint64_t * row = mask.getRow(y);
+    const unsigned char * line = in + (size_t)y * width * channels;
+    for(int w=x0 / 64; w<=(x1 - 1) / 64 && x1 > x0; w++)
+    {
+      uint64_t bits = row[w];
+      if(w == x0 / 64) bits &= ~0ULL << (x0 % 64);
+      if(w == (x1 - 1) / 64 && x1 % 64 != 0) bits &= ~0ULL >> (64 - x1 % 64);
+      while(bits)
+      {
+        int x = w * 64 + ctz64(bits);
+        bits &= bits - 1;
+        counts[binOf(line + x * channels)]++;
+        pixels++;
+      }
+    }
+  }
+  finish(pixels);
+}
+
+//Same from an 8 bit mask where any non zero pixel is foreground.
+void ofxWebcamAppearance::compute(const ofPixels & rgb, const ofRectangle & rect, const ofPixels & mask)
+{
+  int width = mask.getWidth();
+  if(rgb.getNumChannels() < 3 || rgb.getWidth() != mask.getWidth() || rgb.getHeight() != mask.getHeight())
+  {
+    clear();
+    return;
+  }
+
+  int x0 = MAX(0, (int)rect.x);
+  int y0 = MAX(0, (int)rect.y);
+  int x1 = MIN(width, (int)ceil(rect.x + rect.width));
+  int y1 = MIN((int)mask.getHeight(), (int)ceil(rect.y + rect.height));
+  int channels = rgb.getNumChannels();
+  int maskChannels = mask.getNumChannels();
+  const unsigned char * in = rgb.getData();
+  const unsigned char * m = mask.getData();
+
+  memset(counts, 0, sizeof(counts));
+  size_t pixels = 0;
+  for(int y=y0; y<y1; y+=2)
+  {
+    const unsigned char * line = in + (size_t)y * width * channels;
+    const unsigned char * maskLine = m + (size_t)y * width * maskChannels;
+    for(int x=x0; x<x1; x++)
+    {
+      if(maskLine[x * maskChannels] == 0) continue;
+      counts[binOf(line + x * channels)]++;
+      pixels++;
+    }
+  }
+  finish(pixels);
+}
+
+//Moves a quarter of the way towards other, so the descriptor follows slow
+//changes in lighting and pose without being thrown by one bad frame.
+void ofxWebcamAppearance::blend(const ofxWebcamAppearance & other)
+{
+  if(!other.valid) return;
+  if(!valid)
+  {
+    *this = other;
+    return;
+  }
+
+  int i = 0;
+#if defined(__SSE2__)
+  for(; i + 16 <= APPEARANCE_BINS; i += 16)
+  {
+    __m128i a = _mm_loadu_si128((const __m128i *)(bins + i));
+    __m128i b = _mm_loadu_si128((const __m128i *)(other.bins + i));
+    _mm_storeu_si128((__m128i *)(bins + i), _mm_avg_epu8(a, _mm_avg_epu8(a, b)));
+  }
+#endif
+  for(; i < APPEARANCE_BINS; i++)
+  {
+    bins[i] = (uint8_t)((bins[i] * 3 + other.bins[i] + 2) / 4);
+  }
+}
+
+//Half the L1 distance between the normalised histograms: 0 for the same
+//colors, 1 for no colors in common. 1 if either is missing.
+float ofxWebcamAppearance::distance(const ofxWebcamAppearance & other) const
+{
+  if(!valid || !other.valid) return 1;
+
+  int sum = 0;
+  int i = 0;
+#if defined(__SSE2__)
+  __m128i total = _mm_setzero_si128();
+  for(; i + 16 <= APPEARANCE_BINS; i += 16)
+  {
+    __m128i a = _mm_loadu_si128((const __m128i *)(bins + i));
+    __m128i b = _mm_loadu_si128((const __m128i *)(other.bins + i));
+    total = _mm_add_epi64(total, _mm_sad_epu8(a, b));
+  }
+  sum = _mm_cvtsi128_si32(total) + _mm_cvtsi128_si32(_mm_srli_si128(total, 8));
+#endif
+  for(; i < APPEARANCE_BINS; i++)
+  {
+    sum += abs(bins[i] - other.bins[i]);
+  }
+  return MIN(1.0f, sum / 510.0f);
+}
+
+ofxWebcamGallery::ofxWebcamGallery() : capacity(DEFAULT_GALLERY_SIZE) {
+
+}
+
+ofxWebcamGallery::~ofxWebcamGallery(){
+
+}
+
+void ofxWebcamGallery::setCapacity(int value)
+{
+  capacity = MAX(1, value);
+}
+
+int ofxWebcamGallery::getCapacity()
+{
+  return capacity;
+}
+
+size_t ofxWebcamGallery::size()
+{
+  return entries.size();
+}
+
+//The trajectory slots of the dropped entries are added to released.
+void ofxWebcamGallery::clear(vector<int> & released)
+{
+  for(size_t i=0; i<entries.size(); i++)
+  {
+    released.push_back(entries[i].trajectory);
+  }
+  entries.clear();
+}
+
+void ofxWebcamGallery::add(int id, float lostTime, int trajectory, const ofxWebcamAppearance & appearance, vector<int> & released)
+{
+  while((int)entries.size() >= capacity)
+  {
+    //Entries are kept oldest first.
+    released.push_back(entries.front().trajectory);
+    entries.erase(entries.begin());
+  }
+
+  Entry entry;
+  entry.id = id;
+  entry.lostTime = lostTime;
+  entry.trajectory = trajectory;
+  entry.appearance = appearance;
+  entries.push_back(entry);
+}
+
+void ofxWebcamGallery::expire(float now, float maxAge, vector<int> & released)
+{
+  size_t old = 0;
+  while(old < entries.size() && now - entries[old].lostTime > maxAge)
+  {
+    released.push_back(entries[old].trajectory);
+    old++;
+  }
+  entries.erase(entries.begin(), entries.begin() + old);
+}
+
+//Removes and returns the entry that looks most like appearance, if it is
+//closer than maxDistance.
+bool ofxWebcamGallery::take(const ofxWebcamAppearance & appearance, float maxDistance, Entry & found)
+{
+  int best = -1;
+  float bestDistance = maxDistance;
+  for(size_t i=0; i<entries.size(); i++)
+  {
+    float d = appearance.distance(entries[i].appearance);
+    if(d < bestDistance)
+    {
+      best = i;
+      bestDistance = d;
+    }
+  }
+  if(best == -1) return false;
+
+  found = entries[best];
+  entries.erase(entries.begin() + best);
+  return true;
+}
+
+vector<ofxWebcamGallery::Entry> & ofxWebcamGallery::getEntries()
+{
+  return entries;
+}
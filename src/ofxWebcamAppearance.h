@@ -0,0 +1,60 @@
+#pragma once
+#include "ofMain.h"
+#include "ofxWebcamBinaryMask.h"
+
+#define APPEARANCE_BINS 64
+#define APPEARANCE_MIN_PIXELS 32
+#define DEFAULT_GALLERY_SIZE 32
+
+//A blob's colors as a 4x4x4 RGB histogram of its foreground pixels, one
+//byte per bin, scaled so the bins add up to 255. Two descriptors are
+//compared with a sum of absolute differences, 16 bins per instruction.
+class ofxWebcamAppearance {
+  private:
+    uint32_t counts[APPEARANCE_BINS];
+
+    void finish(size_t pixels);
+
+  public:
+    uint8_t bins[APPEARANCE_BINS];
+    bool valid;
+
+    ofxWebcamAppearance();
+
+    void clear();
+    void compute(const ofPixels & rgb, const ofRectangle & rect, ofxWebcamBinaryMask & mask);
+    void compute(const ofPixels & rgb, const ofRectangle & rect, const ofPixels & mask);
+    void blend(const ofxWebcamAppearance & other);
+    float distance(const ofxWebcamAppearance & other) const;
+};
+
+//Tracks that were removed recently, kept with their appearance so the same
+//person coming back can get the old id (and trajectory) again. Holds at
+//most capacity tracks; the oldest one makes room for a new one.
+class ofxWebcamGallery {
+  public:
+    struct Entry {
+      int id;
+      float lostTime;
+      int trajectory;
+      ofxWebcamAppearance appearance;
+    };
+
+  private:
+    vector<Entry> entries;
+    int capacity;
+
+  public:
+    ofxWebcamGallery();
+    ~ofxWebcamGallery();
+
+    void setCapacity(int value);
+    int getCapacity();
+    size_t size();
+    void clear(vector<int> & released);
+
+    void add(int id, float lostTime, int trajectory, const ofxWebcamAppearance & appearance, vector<int> & released);
+    void expire(float now, float maxAge, vector<int> & released);
+    bool take(const ofxWebcamAppearance & appearance, float maxDistance, Entry & found);
+    vector<Entry> & getEntries();
+};
@@ -1,9 +1,21 @@
 #pragma once
 #include "ofMain.h"
 #include "ofxOpenCv.h"
+#include "ofxWebcamFrame.h"
+#include "ofxWebcamLuma.h"
+#include "ofxWebcamFrameSource.h"
 
 #define DEFAULT_RES_WIDTH 640
 #define DEFAULT_RES_HEIGHT 360
+#define DEFAULT_OPEN_TIMEOUT 5000
+#define DEFAULT_STALL_TIMEOUT 2000
+#define DEFAULT_RECONNECT_INTERVAL 2000
+
+enum ofxWebcamSourceStatus {
+  OFX_WEBCAM_SOURCE_OPENING = 0,   //Being opened in the background
+  OFX_WEBCAM_SOURCE_LIVE,          //Delivering frames, part of the stitch
+  OFX_WEBCAM_SOURCE_FAILED         //Could not be opened or stopped delivering, will be reopened
+};
 
 class ofxWebcamImageCalibration
 {
@@ -116,19 +128,130 @@ class ofxWebcamImageCalibration
 class ofxWebcamArray
 {
   private:
-    std::vector<ofVideoGrabber *> webcams;
+    //Where each source is in its life. opening is shared with the thread
+    //that opens it: -1 while it runs, then 0 or 1.
+    struct SourceState {
+      ofxWebcamSourceStatus status;
+      shared_ptr<std::atomic<int> > opening;
+      uint64_t since;
+      uint64_t lastFrame;
+      int width;
+      int height;
+      int reconnects;
+    };
+
+    std::vector<shared_ptr<ofxWebcamFrameSource> > webcams;
+    std::vector<SourceState> states;
+    uint64_t openTimeout;
+    uint64_t stallTimeout;
+    uint64_t reconnectInterval;
     std::vector<ofxWebcamImageCalibration *> calibrations;
     vector<ofVideoDevice> devices;
     vector<ofVideoDevice> activeDevices;
     int detectedWebcamsCache;
+    bool cpuStitch;
+    bool lumaIngest;
+    vector<ofPixels> cameraPixels;
+    vector<uint64_t> captureTimes;
+    uint64_t captureOffset;
+#ifndef OFX_WEBCAM_TRACKER_HEADLESS
     ofFbo colorFbo;
+#endif
     ofPixels colorPixels;
 
+    //Published frames
+    shared_ptr<ofxWebcamFramePool> framePool;
+    shared_ptr<ofxWebcamFramePool> lumaPool;
+    ofxWebcamFrame current;
+    uint64_t lastGrab;
+    std::mutex frameMutex;
+    std::condition_variable frameReady;
+
+    //Screen blends one camera into target following its calibration,
+    //like the FBO path does, sampling with nearest neighbour. The target
+    //is either RGB or a single luma channel.
+    void stitchCamera(ofPixels & src, ofxWebcamImageCalibration & c, ofPixels & target)
+    {
+      int sw = src.getWidth();
+      int sh = src.getHeight();
+      int channels = src.getNumChannels();
+      int tc = target.getNumChannels();
+      if(sw == 0 || sh == 0 || channels == 0) return;
+
+      const unsigned char * in = src.getData();
+      unsigned char * out = target.getData();
+      ofVec2f position = c.getPosition();
+      ofVec2f scale = c.getScale();
+      ofRectangle bounds = c.getBoundingRect();
+
+      int x0 = MAX(0, (int)floor(bounds.x));
+      int y0 = MAX(0, (int)floor(bounds.y));
+      int x1 = MIN(width, (int)ceil(bounds.x + bounds.width));
+      int y1 = MIN(height, (int)ceil(bounds.y + bounds.height));
+
+      bool identity = c.getRotation() == 0 && scale.x == 1 && scale.y == 1 && channels == tc
+                      && position.x == floor(position.x) && position.y == floor(position.y);
+      if(identity)
+      {
+        //The source may be smaller than the resolution it was asked for.
+        x0 = MAX(x0, (int)position.x);
+        y0 = MAX(y0, (int)position.y);
+        x1 = MIN(x1, (int)position.x + sw);
+        y1 = MIN(y1, (int)position.y + sh);
+      }
+
+      float angle = ofDegToRad(-c.getRotation());
+      float cs = cos(angle);
+      float sn = sin(angle);
+
+      for(int y=y0; y<y1; y++)
+      {
+        unsigned char * line = out + ((size_t)y * width) * tc;
+
+        if(identity)
+        {
+          const unsigned char * srcLine = in + ((size_t)(y - (int)position.y) * sw + (x0 - (int)position.x)) * tc;
+          unsigned char * dst = line + x0 * tc;
+          int n = (x1 - x0) * tc;
+          for(int i=0; i<n; i++)
+          {
+            dst[i] = 255 - ((255 - dst[i]) * (255 - srcLine[i])) / 255;
+          }
+          continue;
+        }
+
+        for(int x=x0; x<x1; x++)
+        {
+          float dx = x + 0.5f - position.x;
+          float dy = y + 0.5f - position.y;
+          int sx = (int)floor((dx * cs - dy * sn) / scale.x);
+          int sy = (int)floor((dx * sn + dy * cs) / scale.y);
+          if(sx < 0 || sy < 0 || sx >= sw || sy >= sh) continue;
+
+          const unsigned char * p = in + ((size_t)sy * sw + sx) * channels;
+          unsigned char * dst = line + x * tc;
+          for(int k=0; k<tc; k++)
+          {
+            int v = p[channels < tc ? 0 : k];
+            dst[k] = 255 - ((255 - dst[k]) * (255 - v)) / 255;
+          }
+        }
+      }
+    }
+
   public:
     int width;
     int height;
 
-    ofxWebcamArray() : detectedWebcamsCache(-1), width(0), height(0) {
+#ifdef OFX_WEBCAM_TRACKER_HEADLESS
+    ofxWebcamArray() : openTimeout(DEFAULT_OPEN_TIMEOUT * 1000), stallTimeout(DEFAULT_STALL_TIMEOUT * 1000), reconnectInterval(DEFAULT_RECONNECT_INTERVAL * 1000),
+                       detectedWebcamsCache(-1), cpuStitch(true), lumaIngest(false), captureOffset(0), lastGrab(0), width(0), height(0) {
+#else
+    ofxWebcamArray() : openTimeout(DEFAULT_OPEN_TIMEOUT * 1000), stallTimeout(DEFAULT_STALL_TIMEOUT * 1000), reconnectInterval(DEFAULT_RECONNECT_INTERVAL * 1000),
+                       detectedWebcamsCache(-1), cpuStitch(false), lumaIngest(false), captureOffset(0), lastGrab(0), width(0), height(0) {
+#endif
+      framePool = make_shared<ofxWebcamFramePool>();
+      lumaPool = make_shared<ofxWebcamFramePool>();
 
     }
 
@@ -196,24 +319,80 @@ class ofxWebcamArray
           setActiveDevices(active);
         }
 
+        //The cameras open side by side in the background. The stitched image
+        //has its full size from the start and each camera joins it as soon
+        //as it delivers.
         ofLogNotice("ofxWebcamArray::init") << "Initializing " << activeDevices.size() << " Webcams.";
         for(uint8_t i=0; i<activeDevices.size(); i++)
         {
-          ofVideoGrabber * v = new ofVideoGrabber();
-          v->setDeviceID(activeDevices[i].id);
-          v->setup(resolutionWidth,resolutionHeight);
-          webcams.push_back(v);
-          ofxWebcamImageCalibration * c = new ofxWebcamImageCalibration(i, resolutionWidth, resolutionHeight);
-          calibrations.push_back(c);
-          width += resolutionWidth;
-          height = resolutionHeight;
+          shared_ptr<ofxWebcamFrameSource> v = make_shared<ofxWebcamGrabberSource>(activeDevices[i].id, !cpuStitch, lumaIngest);
+          attachSource(v, resolutionWidth, resolutionHeight);
+          open(i);
         }
 
-        ofLogNotice("ofWebcamArray") << "Alocating FBO of size: " << width << ", " << height;
+        ofLogNotice("ofWebcamArray") << "Alocating image of size: " << width << ", " << height;
         allocateImages();
       }
     }
 
+    //Adds a source that is not a local webcam, like a recording or the
+    //synthetic scene, to the right of the others. It is set up here.
+    void addSource(shared_ptr<ofxWebcamFrameSource> source, int resolutionWidth=DEFAULT_RES_WIDTH, int resolutionHeight=DEFAULT_RES_HEIGHT)
+    {
+      bool opened = source->setup(resolutionWidth, resolutionHeight);
+      if(!opened)
+      {
+        ofLogError("ofxWebcamArray::addSource") << "Could not set up source " << webcams.size();
+      }
+      attachSource(source, resolutionWidth, resolutionHeight);
+      setStatus(webcams.size() - 1, opened ? OFX_WEBCAM_SOURCE_LIVE : OFX_WEBCAM_SOURCE_FAILED, getClock());
+#ifndef OFX_WEBCAM_TRACKER_HEADLESS
+      if(!source->canDraw())
+      {
+        cpuStitch = true;
+      }
+#endif
+      allocateImages();
+    }
+
+    void attachSource(shared_ptr<ofxWebcamFrameSource> source, int resolutionWidth, int resolutionHeight)
+    {
+      uint8_t i = webcams.size();
+      if(lumaIngest && !ofxWebcamLuma::isSupported(source->getPixelFormat()))
+      {
+        ofLogError("ofxWebcamArray::init") << "Webcam " << (int)i << " delivers a pixel format without a luma path";
+      }
+      webcams.push_back(source);
+      SourceState state = {OFX_WEBCAM_SOURCE_OPENING, shared_ptr<std::atomic<int> >(), getClock(), 0, resolutionWidth, resolutionHeight, 0};
+      states.push_back(state);
+      ofxWebcamImageCalibration * c = new ofxWebcamImageCalibration(i, resolutionWidth, resolutionHeight);
+      calibrations.push_back(c);
+      width += resolutionWidth;
+      height = MAX(height, resolutionHeight);
+      cameraPixels.resize(webcams.size());
+      captureTimes.resize(webcams.size(), 0);
+    }
+
+    shared_ptr<ofxWebcamFrameSource> getSource(uint8_t index)
+    {
+      return index < webcams.size() ? webcams[index] : shared_ptr<ofxWebcamFrameSource>();
+    }
+
+    int getNumSources()
+    {
+      return webcams.size();
+    }
+
+    //True when every source is simulated, so frames follow their clock.
+    bool isSimulated()
+    {
+      for(uint8_t i=0; i<webcams.size(); i++)
+      {
+        if(!webcams[i]->isSimulated()) return false;
+      }
+      return !webcams.empty();
+    }
+
     void init(int resolutionWidth=DEFAULT_RES_WIDTH, int resolutionHeight=DEFAULT_RES_HEIGHT){
       vector<ofVideoDevice> empty;
       init(empty, resolutionWidth, resolutionHeight);
@@ -221,27 +400,411 @@ class ofxWebcamArray
 
     void allocateImages()
     {
-      colorFbo.allocate(width, height, GL_RGB);
-      colorPixels.allocate(width, height, GL_RGB);
+#ifndef OFX_WEBCAM_TRACKER_HEADLESS
+      if(!cpuStitch)
+      {
+        colorFbo.allocate(width, height, GL_RGB);
+      }
+#endif
+      colorPixels.allocate(width, height, OF_PIXELS_RGB);
+    }
+
+    //Stitch on the CPU instead of through an FBO. Always on in headless
+    //builds; otherwise call before init() so the grabbers skip their textures.
+    void setCpuStitch(bool value)
+    {
+#ifndef OFX_WEBCAM_TRACKER_HEADLESS
+      cpuStitch = value || lumaIngest;
+      if(!cpuStitch && width > 0)
+      {
+        colorFbo.allocate(width, height, GL_RGB);
+      }
+#else
+      (void)value;
+#endif
+    }
+
+    bool getCpuStitch()
+    {
+      return cpuStitch;
+    }
+
+    //Asks the cameras for their native format and publishes only the luma
+    //plane, skipping the conversion to RGB. Color is then only stitched on
+    //request through getPixels(). Call before init().
+    void setLumaIngest(bool value)
+    {
+      lumaIngest = value;
+      if(lumaIngest)
+      {
+        cpuStitch = true;
+      }
+    }
+
+    bool getLumaIngest()
+    {
+      return lumaIngest;
+    }
+
+    //Starts opening a source. Cameras open on a thread of their own so a
+    //slow or hanging driver holds up nobody; the thread keeps the source
+    //alive until it returns. Simulated sources open right away, so runs
+    //stay repeatable.
+    void open(int i)
+    {
+      SourceState & state = states[i];
+      shared_ptr<std::atomic<int> > result = make_shared<std::atomic<int> >(-1);
+      state.opening = result;
+      setStatus(i, OFX_WEBCAM_SOURCE_OPENING, getClock());
+
+      shared_ptr<ofxWebcamFrameSource> source = webcams[i];
+      int w = state.width;
+      int h = state.height;
+      if(source->isSimulated())
+      {
+        result->store(source->setup(w, h) ? 1 : 0);
+        return;
+      }
+      std::thread([source, result, w, h]{
+        result->store(source->setup(w, h) ? 1 : 0);
+      }).detach();
     }
 
+    void setStatus(int i, ofxWebcamSourceStatus status, uint64_t now)
+    {
+      states[i].status = status;
+      states[i].since = now;
+      states[i].lastFrame = now;
+      if(status != OFX_WEBCAM_SOURCE_LIVE)
+      {
+        captureTimes[i] = 0;
+      }
+    }
+
+    //Microseconds on the sources' clock: the app's for cameras, the
+    //scene's for simulated sources.
+    uint64_t getClock()
+    {
+      if(!isSimulated()) return ofGetElapsedTimeMicros();
+      uint64_t now = 0;
+      for(size_t i=0; i<webcams.size(); i++)
+      {
+        now = MAX(now, webcams[i]->getCaptureTime());
+      }
+      return now;
+    }
+
+    //Watchdog for sources that are not live: picks up finished opens,
+    //gives up on opens that take too long and reopens failed sources
+    //after a while. Their part of the stitch stays black meanwhile.
+    void watch(int i, uint64_t now)
+    {
+      SourceState & state = states[i];
+      int opened = state.opening ? state.opening->load() : 0;
+      if(opened == 1)
+      {
+        state.opening.reset();
+        setStatus(i, OFX_WEBCAM_SOURCE_LIVE, now);
+        ofLogNotice("ofxWebcamArray::update") << "Webcam " << i << " is live";
+      }
+      else if(opened == 0 && state.opening)
+      {
+        state.opening.reset();
+        setStatus(i, OFX_WEBCAM_SOURCE_FAILED, now);
+        ofLogError("ofxWebcamArray::update") << "Webcam " << i << " could not be opened";
+      }
+      else if(state.status == OFX_WEBCAM_SOURCE_OPENING && now - state.since > openTimeout)
+      {
+        //The open keeps running and is picked up if it ever finishes.
+        setStatus(i, OFX_WEBCAM_SOURCE_FAILED, now);
+        ofLogError("ofxWebcamArray::update") << "Webcam " << i << " timed out opening";
+      }
+      else if(state.status == OFX_WEBCAM_SOURCE_FAILED && !state.opening && !webcams[i]->isFinished() && now - state.since >= reconnectInterval)
+      {
+        state.reconnects++;
+        ofLogNotice("ofxWebcamArray::update") << "Reopening webcam " << i;
+        open(i);
+      }
+    }
+
+    //Each camera's new image is stamped right after it arrives, minus the
+    //known delay between exposure and delivery set with setCaptureOffset().
+    //A live camera that stops delivering for the stall timeout is closed
+    //and reopened by the watchdog, unless it is a recording that ended.
     void update()
     {
+      uint64_t now = getClock();
       for(uint8_t i=0; i<webcams.size(); i++)
       {
+        if(states[i].status != OFX_WEBCAM_SOURCE_LIVE)
+        {
+          watch(i, now);
+          continue;
+        }
+
         webcams[i]->update();
+        if(webcams[i]->isFrameNew())
+        {
+          uint64_t stamp = webcams[i]->getCaptureTime();
+          uint64_t arrival = stamp > 0 ? stamp : ofGetElapsedTimeMicros();
+          captureTimes[i] = arrival > captureOffset ? arrival - captureOffset : 0;
+          states[i].lastFrame = now;
+        }
+        else if(!webcams[i]->isFinished() && now - states[i].lastFrame > stallTimeout)
+        {
+          ofLogError("ofxWebcamArray::update") << "Webcam " << (int)i << " stopped delivering";
+          webcams[i]->close();
+          setStatus(i, OFX_WEBCAM_SOURCE_FAILED, now);
+        }
+      }
+    }
+
+    bool isFrameNew()
+    {
+      for(uint8_t i=0; i<webcams.size(); i++)
+      {
+        if(isLive(i) && webcams[i]->isFrameNew()) return true;
+      }
+      return false;
+    }
+
+    bool isLive(uint8_t index)
+    {
+      return index < states.size() && states[index].status == OFX_WEBCAM_SOURCE_LIVE;
+    }
+
+    ofxWebcamSourceStatus getSourceStatus(uint8_t index)
+    {
+      return index < states.size() ? states[index].status : OFX_WEBCAM_SOURCE_FAILED;
+    }
+
+    int getNumLiveSources()
+    {
+      int live = 0;
+      for(uint8_t i=0; i<states.size(); i++)
+      {
+        if(isLive(i)) live++;
       }
+      return live;
+    }
+
+    //How many times a source was reopened after failing.
+    int getReconnects(uint8_t index)
+    {
+      return index < states.size() ? states[index].reconnects : 0;
+    }
+
+    //How long a camera may take to open before it counts as failed.
+    void setOpenTimeout(float millis)
+    {
+      openTimeout = (uint64_t)(MAX(0, millis) * 1000);
+    }
+
+    //How long a live camera may go without a new image before it is reopened.
+    void setStallTimeout(float millis)
+    {
+      stallTimeout = (uint64_t)(MAX(0, millis) * 1000);
+    }
+
+    //How long to wait before reopening a failed camera.
+    void setReconnectInterval(float millis)
+    {
+      reconnectInterval = (uint64_t)(MAX(0, millis) * 1000);
     }
 
+    void setCaptureOffset(float millis)
+    {
+      captureOffset = (uint64_t)(MAX(0, millis) * 1000);
+    }
+
+    float getCaptureOffset()
+    {
+      return captureOffset / 1000.0f;
+    }
+
+    uint64_t getCaptureTime(uint8_t index)
+    {
+      return index < captureTimes.size() ? captureTimes[index] : 0;
+    }
+
+    //The oldest of the cameras' latest images, which is how old the
+    //stitched frame is at least.
+    uint64_t getCaptureTime()
+    {
+      uint64_t oldest = 0;
+      for(size_t i=0; i<captureTimes.size(); i++)
+      {
+        if(captureTimes[i] > 0 && (oldest == 0 || captureTimes[i] < oldest))
+        {
+          oldest = captureTimes[i];
+        }
+      }
+      return oldest > 0 ? oldest : ofGetElapsedTimeMicros();
+    }
+
+    //Sources still being opened are closed by their own thread's release.
     void close()
     {
       for(uint8_t i=0; i<webcams.size(); i++)
       {
-        webcams[i]->close();
+        if(!states[i].opening)
+        {
+          webcams[i]->close();
+        }
+      }
+    }
+
+    bool isInitialized()
+    {
+      return width > 0;
+    }
+
+    ofPixels & getPixels()
+    {
+      stitch(colorPixels);
+      return colorPixels;
+    }
+
+    void stitch(ofPixels & target)
+    {
+#ifndef OFX_WEBCAM_TRACKER_HEADLESS
+      if(!cpuStitch)
+      {
+        drawPixels(target);
+        return;
+      }
+#endif
+      stitchPixels(target);
+    }
+
+    void stitchPixels(ofPixels & target)
+    {
+      if(!target.isAllocated() || (int)target.getWidth() != width || (int)target.getHeight() != height)
+      {
+        target.allocate(width, height, OF_PIXELS_RGB);
+      }
+      target.set(0);
+      for(uint8_t i=0; i<webcams.size(); i++)
+      {
+        if(!isLive(i)) continue;
+        ofPixels & src = webcams[i]->getPixels();
+        ofPixelFormat format = src.getPixelFormat();
+        if(format == OF_PIXELS_RGB || format == OF_PIXELS_RGBA || format == OF_PIXELS_GRAY)
+        {
+          stitchCamera(src, *calibrations[i], target);
+        }
+        else
+        {
+          ofxWebcamLuma::toRgb(src, cameraPixels[i]);
+          stitchCamera(cameraPixels[i], *calibrations[i], target);
+        }
+      }
+    }
+
+    void stitchLuma(ofPixels & target)
+    {
+      if(!target.isAllocated() || (int)target.getWidth() != width || (int)target.getHeight() != height || target.getNumChannels() != 1)
+      {
+        target.allocate(width, height, OF_PIXELS_GRAY);
+      }
+      target.set(0);
+      for(uint8_t i=0; i<webcams.size(); i++)
+      {
+        if(!isLive(i)) continue;
+        ofPixels & src = webcams[i]->getPixels();
+        if(src.getPixelFormat() == OF_PIXELS_GRAY)
+        {
+          stitchCamera(src, *calibrations[i], target);
+        }
+        else
+        {
+          ofxWebcamLuma::extract(src, cameraPixels[i]);
+          stitchCamera(cameraPixels[i], *calibrations[i], target);
+        }
       }
     }
 
-    ofPixels & getPixels() //TODO: This is failing only a pixel on top!!
+    //Updates the cameras and publishes a new stitched frame, at most once per
+    //app frame, so any number of trackers sharing this array can call it and
+    //all get the same frame without stitching it again.
+    ofxWebcamFrame grab()
+    {
+      bool simulated = isSimulated();
+      if(simulated)
+      {
+        //Simulated sources decide themselves when there is a new frame.
+        update();
+      }
+      else
+      {
+        if(current.number > 0 && lastGrab == ofGetFrameNum())
+        {
+          return getFrame();
+        }
+        lastGrab = ofGetFrameNum();
+        update();
+      }
+
+      //A frame is only published when some camera delivered a new image,
+      //so consumers never see the same picture under a new number.
+      if(getNumLiveSources() == 0 || !isFrameNew())
+      {
+        return getFrame();
+      }
+
+      shared_ptr<ofPixels> buffer;
+      if(lumaIngest)
+      {
+        buffer = lumaPool->acquire();
+        stitchLuma(*buffer);
+      }
+      else
+      {
+        buffer = framePool->acquire();
+        stitch(*buffer);
+      }
+
+      {
+        std::lock_guard<std::mutex> guard(frameMutex);
+        current.pixels = lumaIngest ? shared_ptr<ofPixels>() : buffer;
+        current.luma = lumaIngest ? buffer : shared_ptr<ofPixels>();
+        current.number++;
+        current.captureTime = getCaptureTime();
+        current.simulated = simulated;
+      }
+      frameReady.notify_all();
+      return getFrame();
+    }
+
+    ofxWebcamFrame getFrame()
+    {
+      std::lock_guard<std::mutex> guard(frameMutex);
+      return current;
+    }
+
+    //Blocks a consumer thread until a frame newer than lastNumber is
+    //published or the timeout runs out.
+    bool waitForFrame(uint64_t lastNumber, int timeoutMillis, ofxWebcamFrame & frame)
+    {
+      std::unique_lock<std::mutex> guard(frameMutex);
+      bool fresh = frameReady.wait_for(guard, std::chrono::milliseconds(timeoutMillis), [&]{
+        return current.number > 0 && current.number != lastNumber;
+      });
+      if(fresh)
+      {
+        frame = current;
+      }
+      return fresh;
+    }
+
+    //Wakes up threads blocked in waitForFrame() so they can check if they should stop.
+    void notifyWaiting()
+    {
+      frameReady.notify_all();
+    }
+
+#ifndef OFX_WEBCAM_TRACKER_HEADLESS
+    void drawPixels(ofPixels & target) //TODO: This is failing only a pixel on top!!
     {
       colorFbo.begin();
       glViewport(0, 0, width, height);
@@ -250,6 +813,7 @@ class ofxWebcamArray
       ofEnableBlendMode(OF_BLENDMODE_SCREEN);
       for(uint8_t i=0; i<webcams.size(); i++)
       {
+        if(!isLive(i)) continue;
         ofPushMatrix();
         ofTranslate(calibrations[i]->getPosition().x, calibrations[i]->getPosition().y);
         ofRotateDeg(calibrations[i]->getRotation());
@@ -260,9 +824,19 @@ class ofxWebcamArray
       ofEnableBlendMode(OF_BLENDMODE_ALPHA);
       colorFbo.end();
 
-      colorFbo.readToPixels(colorPixels);
+      colorFbo.readToPixels(target);
+    }
+#endif
 
-      return colorPixels;
+    //Where each camera lands in the stitched image.
+    vector<ofRectangle> getCameraRects()
+    {
+      vector<ofRectangle> rects;
+      for(uint8_t i=0; i<calibrations.size(); i++)
+      {
+        rects.push_back(calibrations[i]->getBoundingRect());
+      }
+      return rects;
     }
 
     void calibratePosition(uint8_t index, ofPoint p)
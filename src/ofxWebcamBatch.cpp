@@ -0,0 +1,243 @@
+#include "ofxWebcamBatch.h"
+
+#ifdef OFX_WEBCAM_TRACKER_HEADLESS
+
+ofxWebcamBatch::ofxWebcamBatch() : resolutionWidth(DEFAULT_RES_WIDTH), resolutionHeight(DEFAULT_RES_HEIGHT), numQueues(0), frames(0), finished(0), steals(0), running(false), seconds(0) {
+
+}
+
+ofxWebcamBatch::~ofxWebcamBatch(){
+
+}
+
+//Returns the session's index in getSessions().
+int ofxWebcamBatch::addSession(const vector<string> & videos, string output, string name)
+{
+  ofxWebcamBatchSession session;
+  session.name = name.empty() ? output : name;
+  session.videos = videos;
+  session.output = output;
+  session.ok = false;
+  session.frames = 0;
+  session.seconds = 0;
+  session.worker = -1;
+  sessions.push_back(session);
+  return sessions.size() - 1;
+}
+
+void ofxWebcamBatch::clearSessions()
+{
+  sessions.clear();
+}
+
+//Called on a worker thread with each session's tracker before it starts,
+//to apply the settings being tried. Runs on several threads at once.
+void ofxWebcamBatch::setConfigure(std::function<void(ofxWebcamTracker &)> callback)
+{
+  configure = callback;
+}
+
+//Size of each camera's part of the stitched image.
+void ofxWebcamBatch::setResolution(int width, int height)
+{
+  resolutionWidth = width;
+  resolutionHeight = height;
+}
+
+//Processes every session and returns when all are done, true if all of them
+//could be read. threads is the number of workers, one per core by default.
+bool ofxWebcamBatch::run(int threads)
+{
+  if(sessions.empty()) return true;
+
+  if(threads <= 0)
+  {
+    threads = MAX(1, (int)std::thread::hardware_concurrency());
+  }
+  numQueues = MIN(threads, (int)sessions.size());
+  queues.reset(new Queue[numQueues]);
+  for(size_t i=0; i<sessions.size(); i++)
+  {
+    sessions[i].ok = false;
+    sessions[i].frames = 0;
+    sessions[i].seconds = 0;
+    sessions[i].worker = -1;
+    queues[i % numQueues].sessions.push_back(i);
+  }
+  frames = 0;
+  finished = 0;
+  steals = 0;
+  running = true;
+
+  uint64_t start = ofGetElapsedTimeMicros();
+  vector<std::thread> workers;
+  for(int w=0; w<numQueues; w++)
+  {
+    workers.push_back(std::thread(&ofxWebcamBatch::work, this, w));
+  }
+  for(size_t w=0; w<workers.size(); w++)
+  {
+    workers[w].join();
+  }
+  seconds = (ofGetElapsedTimeMicros() - start) / 1000000.0f;
+  running = false;
+
+  bool ok = true;
+  for(size_t i=0; i<sessions.size(); i++)
+  {
+    ok = ok && sessions[i].ok;
+  }
+  ofLogNotice("ofxWebcamBatch") << sessions.size() << " sessions, " << getFrames() << " frames in " << seconds << "s on " << numQueues << " threads, " << getFps() << " fps";
+  return ok;
+}
+
+//Own work comes from the back of the queue, stolen work from the front.
+bool ofxWebcamBatch::take(int worker, int & session)
+{
+  {
+    Queue & own = queues[worker];
+    std::lock_guard<std::mutex> guard(own.mutex);
+    if(!own.sessions.empty())
+    {
+      session = own.sessions.back();
+      own.sessions.pop_back();
+      return true;
+    }
+  }
+
+  for(int i=1; i<numQueues; i++)
+  {
+    Queue & other = queues[(worker + i) % numQueues];
+    std::lock_guard<std::mutex> guard(other.mutex);
+    if(!other.sessions.empty())
+    {
+      session = other.sessions.front();
+      other.sessions.pop_front();
+      steals++;
+      return true;
+    }
+  }
+  return false;
+}
+
+void ofxWebcamBatch::work(int worker)
+{
+  int session;
+  while(take(worker, session))
+  {
+    sessions[session].worker = worker;
+    runSession(sessions[session]);
+    finished++;
+  }
+}
+
+//Plays the session's recordings through a tracker of its own, one frame per
+//update, until every camera is done.
+void ofxWebcamBatch::runSession(ofxWebcamBatchSession & session)
+{
+  uint64_t start = ofGetElapsedTimeMicros();
+  shared_ptr<ofxWebcamArray> array = make_shared<ofxWebcamArray>();
+  vector<shared_ptr<ofxWebcamVideoSource> > sources;
+  for(size_t i=0; i<session.videos.size(); i++)
+  {
+    shared_ptr<ofxWebcamVideoSource> source = make_shared<ofxWebcamVideoSource>(session.videos[i]);
+    array->addSource(source, resolutionWidth, resolutionHeight);
+    sources.push_back(source);
+  }
+  if(array->getNumLiveSources() == 0)
+  {
+    ofLogError("ofxWebcamBatch") << "No recording of " << session.name << " could be opened";
+    return;
+  }
+
+  ofxWebcamTracker tracker;
+  tracker.init(array);
+  if(configure)
+  {
+    configure(tracker);
+  }
+  //The quality levels follow the wall clock, which would make the blobs
+  //depend on how busy the machine is.
+  tracker.setLatencyTarget(0);
+  if(!session.output.empty() && !tracker.startLog(session.output))
+  {
+    ofLogError("ofxWebcamBatch") << "Could not write " << session.output;
+  }
+
+  uint64_t last = 0;
+  while(true)
+  {
+    tracker.update();
+    uint64_t number = array->getFrame().number;
+    if(number != last)
+    {
+      frames += number - last;
+      last = number;
+    }
+
+    //Cameras that could not be opened have nothing left to play.
+    bool done = true;
+    for(size_t i=0; i<sources.size(); i++)
+    {
+      if(array->isLive(i) && !sources[i]->isFinished()) done = false;
+    }
+    if(done) break;
+  }
+
+  session.ok = true;
+  for(size_t i=0; i<sources.size(); i++)
+  {
+    int total = sources[i]->getTotalFrames();
+    if(!sources[i]->isFinished() || (total > 0 && sources[i]->getFrame() < total - 1))
+    {
+      ofLogError("ofxWebcamBatch") << session.name << ": " << session.videos[i] << " stopped at frame " << sources[i]->getFrame();
+      session.ok = false;
+    }
+  }
+
+  tracker.close();
+  array->close();
+  session.frames = last;
+  session.seconds = (ofGetElapsedTimeMicros() - start) / 1000000.0f;
+}
+
+bool ofxWebcamBatch::isRunning()
+{
+  return running;
+}
+
+vector<ofxWebcamBatchSession> & ofxWebcamBatch::getSessions()
+{
+  return sessions;
+}
+
+//Progress, safe to read from another thread while run() is busy.
+int ofxWebcamBatch::getNumFinished()
+{
+  return finished;
+}
+
+uint64_t ofxWebcamBatch::getFrames()
+{
+  return frames;
+}
+
+//Sessions a worker took from another worker's queue.
+int ofxWebcamBatch::getSteals()
+{
+  return steals;
+}
+
+//Wall clock seconds the last run() took.
+float ofxWebcamBatch::getSeconds()
+{
+  return seconds;
+}
+
+//Frames per second of all sessions together, over the last run().
+float ofxWebcamBatch::getFps()
+{
+  return seconds > 0 ? getFrames() / seconds : 0;
+}
+
+#endif
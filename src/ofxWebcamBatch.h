@@ -0,0 +1,73 @@
+#pragma once
+#include "ofMain.h"
+#include "ofxWebcamTracker.h"
+#include <deque>
+
+//Only in headless builds, where trackers create no textures and can run
+//on any thread.
+#ifdef OFX_WEBCAM_TRACKER_HEADLESS
+
+//One recorded session: a recording per camera, placed side by side like
+//live cameras, and where to write its blobs.
+struct ofxWebcamBatchSession {
+  string name;
+  vector<string> videos;
+  string output;   //Blob log, read it back with ofxWebcamLogReader
+
+  //Filled in by run()
+  bool ok;
+  uint64_t frames;
+  float seconds;
+  int worker;
+};
+
+//Re-runs the tracker over many recorded sessions at once, each as fast as
+//a core allows, on the recordings' own clock so a session always gives
+//the same blobs. Every worker starts with its share of the sessions and
+//works through them from the back; one that runs out steals from the
+//front of another's queue, so a few long sessions do not leave the other
+//cores idle at the end.
+class ofxWebcamBatch {
+  private:
+    struct Queue {
+      std::mutex mutex;
+      std::deque<int> sessions;
+    };
+
+    vector<ofxWebcamBatchSession> sessions;
+    std::function<void(ofxWebcamTracker &)> configure;
+    int resolutionWidth;
+    int resolutionHeight;
+    std::unique_ptr<Queue[]> queues;
+    int numQueues;
+    std::atomic<uint64_t> frames;
+    std::atomic<int> finished;
+    std::atomic<int> steals;
+    std::atomic<bool> running;
+    float seconds;
+
+    bool take(int worker, int & session);
+    void work(int worker);
+    void runSession(ofxWebcamBatchSession & session);
+
+  public:
+    ofxWebcamBatch();
+    ~ofxWebcamBatch();
+
+    int addSession(const vector<string> & videos, string output, string name="");
+    void clearSessions();
+    void setConfigure(std::function<void(ofxWebcamTracker &)> callback);
+    void setResolution(int width, int height);
+
+    bool run(int threads=0);
+    bool isRunning();
+
+    vector<ofxWebcamBatchSession> & getSessions();
+    int getNumFinished();
+    uint64_t getFrames();
+    int getSteals();
+    float getSeconds();
+    float getFps();
+};
+
+#endif
@@ -0,0 +1,478 @@
+#include "ofxWebcamBinaryMask.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+static inline int popcount64(uint64_t v) { return (int)__popcnt64(v); }
+static inline int ctz64(uint64_t v) { unsigned long i; _BitScanForward64(&i, v); return (int)i; }
+#else
+static inline int popcount64(uint64_t v) { return __builtin_popcountll(v); }
+static inline int ctz64(uint64_t v) { return __builtin_ctzll(v); }
+#endif
+
+//Shifts a packed row so that out(x) = in(x+k). Bits coming from outside
+//the row are filled with fill (all ones or all zeros).
+static void shiftRow(const uint64_t * in, uint64_t * out, int words, int k, uint64_t fill)
+{
+  int wordShift = k / 64;
+  int bitShift = k % 64;
+  for(int w=0; w<words; w++)
+  {
+    int src = w + wordShift;
+    uint64_t lo = src < words ? in[src] : fill;
+    uint64_t hi = src + 1 < words ? in[src + 1] : fill;
+    out[w] = bitShift == 0 ? lo : (lo >> bitShift) | (hi << (64 - bitShift));
+  }
+}
+
+//Same as shiftRow but out(x) = in(x-k).
+static void shiftRowBack(const uint64_t * in, uint64_t * out, int words, int k, uint64_t fill)
+{
+  int wordShift = k / 64;
+  int bitShift = k % 64;
+  for(int w=0; w<words; w++)
+  {
+    int src = w - wordShift;
+    uint64_t hi = src >= 0 ? in[src] : fill;
+    uint64_t lo = src - 1 >= 0 ? in[src - 1] : fill;
+    out[w] = bitShift == 0 ? hi : (hi << bitShift) | (lo >> (64 - bitShift));
+  }
+}
+
+template<bool Erode> static inline uint64_t combine(uint64_t a, uint64_t b)
+{
+  return Erode ? (a & b) : (a | b);
+}
+
+ofxWebcamBinaryMask::ofxWebcamBinaryMask() : width(0), height(0), wordsPerRow(0) {
+
+}
+
+ofxWebcamBinaryMask::~ofxWebcamBinaryMask(){
+
+}
+
+void ofxWebcamBinaryMask::allocate(int w, int h)
+{
+  width = w;
+  height = h;
+  wordsPerRow = (w + 63) / 64;
+  bits.assign((size_t)wordsPerRow * height, 0);
+  scratch.assign(wordsPerRow, 0);
+  shifted.assign(wordsPerRow, 0);
+  scratchBack.assign(wordsPerRow, 0);
+}
+
+bool ofxWebcamBinaryMask::isAllocated()
+{
+  return !bits.empty();
+}
+
+void ofxWebcamBinaryMask::clear()
+{
+  std::fill(bits.begin(), bits.end(), 0);
+}
+
+uint64_t ofxWebcamBinaryMask::tailMask()
+{
+  int used = width % 64;
+  return used == 0 ? ~0ULL : (1ULL << used) - 1;
+}
+
+void ofxWebcamBinaryMask::setFromPixels(const ofPixels & pix)
+{
+  if((int)pix.getWidth() != width || (int)pix.getHeight() != height)
+  {
+    allocate(pix.getWidth(), pix.getHeight());
+  }
+
+  const unsigned char * src = pix.getData();
+  int channels = pix.getNumChannels();
+
+  for(int y=0; y<height; y++)
+  {
+    const unsigned char * line = src + (size_t)y * width * channels;
+    uint64_t * row = getRow(y);
+    int x = 0;
+
+#if defined(__SSE2__)
+    if(channels == 1)
+    {
+      const __m128i zero = _mm_setzero_si128();
+      for(; x + 64 <= width; x += 64)
+      {
+        uint64_t word = 0;
+        for(int k=0; k<4; k++)
+        {
+          __m128i v = _mm_loadu_si128((const __m128i *)(line + x + k*16));
+          uint64_t isZero = (uint64_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, zero));
+          word |= (~isZero & 0xFFFF) << (k*16);
+        }
+        row[x / 64] = word;
+      }
+    }
+#endif
+
+    for(; x < width; x += 64)
+    {
+      uint64_t word = 0;
+      int n = MIN(64, width - x);
+      for(int i=0; i<n; i++)
+      {
+        if(line[(x + i) * channels] != 0) word |= 1ULL << i;
+      }
+      row[x / 64] = word;
+    }
+  }
+}
+
+//Thresholds |image - reference| and packs the result in one pass, so the
+//8 bit diff never has to be written. A pixel is foreground when the
+//difference is not below the threshold, same as the 8 bit path.
+void ofxWebcamBinaryMask::setFromDifference(const ofPixels & image, const ofPixels & reference, float threshold)
+{
+  if((int)image.getWidth() != width || (int)image.getHeight() != height)
+  {
+    allocate(image.getWidth(), image.getHeight());
+  }
+
+  int limit = (int)ceil(ofClamp(threshold, 0, 255));
+  const unsigned char * a = image.getData();
+  const unsigned char * b = reference.getData();
+
+  for(int y=0; y<height; y++)
+  {
+    const unsigned char * la = a + (size_t)y * width;
+    const unsigned char * lb = b + (size_t)y * width;
+    uint64_t * row = getRow(y);
+    int x = 0;
+
+    if(limit == 0)
+    {
+      for(int w=0; w<wordsPerRow; w++) row[w] = ~0ULL;
+      row[wordsPerRow - 1] &= tailMask();
+      continue;
+    }
+
+#if defined(__SSE2__)
+    const __m128i below = _mm_set1_epi8((char)(limit - 1));
+    const __m128i zero = _mm_setzero_si128();
+    for(; x + 64 <= width; x += 64)
+    {
+      uint64_t word = 0;
+      for(int k=0; k<4; k++)
+      {
+        __m128i va = _mm_loadu_si128((const __m128i *)(la + x + k*16));
+        __m128i vb = _mm_loadu_si128((const __m128i *)(lb + x + k*16));
+        __m128i d = _mm_or_si128(_mm_subs_epu8(va, vb), _mm_subs_epu8(vb, va));
+        //d >= limit exactly when d - (limit-1) does not saturate to 0
+        __m128i background = _mm_cmpeq_epi8(_mm_subs_epu8(d, below), zero);
+        uint64_t isBackground = (uint64_t)_mm_movemask_epi8(background);
+        word |= (~isBackground & 0xFFFF) << (k*16);
+      }
+      row[x / 64] = word;
+    }
+#endif
+
+    for(; x < width; x += 64)
+    {
+      uint64_t word = 0;
+      int n = MIN(64, width - x);
+      for(int i=0; i<n; i++)
+      {
+        if(abs(la[x + i] - lb[x + i]) >= limit) word |= 1ULL << i;
+      }
+      row[x / 64] = word;
+    }
+  }
+}
+
+void ofxWebcamBinaryMask::toPixels(ofPixels & pix)
+{
+  if((int)pix.getWidth() != width || (int)pix.getHeight() != height || pix.getNumChannels() != 1)
+  {
+    pix.allocate(width, height, OF_PIXELS_GRAY);
+  }
+
+  unsigned char * dst = pix.getData();
+
+  for(int y=0; y<height; y++)
+  {
+    unsigned char * line = dst + (size_t)y * width;
+    uint64_t * row = getRow(y);
+    int x = 0;
+
+#if defined(__SSE2__)
+    //Each byte lane tests its own bit of the broadcast 16 bit chunk.
+    const __m128i select = _mm_set_epi8((char)0x80, 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x01,
+                                        (char)0x80, 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x01);
+    for(; x + 16 <= width; x += 16)
+    {
+      unsigned int chunk = (unsigned int)(row[x / 64] >> (x % 64)) & 0xFFFF;
+      uint64_t lo = 0x0101010101010101ULL * (chunk & 0xFF);
+      uint64_t hi = 0x0101010101010101ULL * (chunk >> 8);
+      __m128i lanes = _mm_set_epi64x((long long)hi, (long long)lo);
+      __m128i set = _mm_cmpeq_epi8(_mm_and_si128(lanes, select), select);
+      _mm_storeu_si128((__m128i *)(line + x), set);
+    }
+#endif
+
+    for(; x < width; x++)
+    {
+      line[x] = (row[x / 64] >> (x % 64)) & 1 ? 255 : 0;
+    }
+  }
+}
+
+//Appends the foreground runs of every row, in row order, using the
+//lowest set bit to jump straight to each run boundary.
+void ofxWebcamBinaryMask::extractRuns(vector<ofxWebcamRun> & runs)
+{
+  runs.clear();
+  for(int y=0; y<height; y++)
+  {
+    const uint64_t * row = getRow(y);
+    int runStart = -1;
+
+    for(int w=0; w<wordsPerRow; w++)
+    {
+      uint64_t word = row[w];
+      int base = w * 64;
+      int bit = 0;
+
+      while(bit < 64)
+      {
+        uint64_t above = ~0ULL << bit;
+        if(runStart < 0)
+        {
+          uint64_t ones = word & above;
+          if(ones == 0) break;
+          bit = ctz64(ones);
+          runStart = base + bit;
+        }
+        else
+        {
+          uint64_t zeros = ~word & above;
+          if(zeros == 0) break;
+          bit = ctz64(zeros);
+          ofxWebcamRun run = {y, runStart, base + bit - 1};
+          runs.push_back(run);
+          runStart = -1;
+        }
+      }
+    }
+
+    if(runStart >= 0)
+    {
+      ofxWebcamRun run = {y, runStart, width - 1};
+      runs.push_back(run);
+    }
+  }
+}
+
+size_t ofxWebcamBinaryMask::count()
+{
+  size_t total = 0;
+  for(size_t i=0; i<bits.size(); i++)
+  {
+    total += popcount64(bits[i]);
+  }
+  return total;
+}
+
+//Set bits of row y in [start, end).
+int ofxWebcamBinaryMask::count(int y, int start, int end)
+{
+  if(end <= start) return 0;
+
+  const uint64_t * row = getRow(y);
+  int first = start / 64;
+  int last = (end - 1) / 64;
+  uint64_t lowMask = ~0ULL << (start % 64);
+  uint64_t highMask = (end % 64) == 0 ? ~0ULL : (1ULL << (end % 64)) - 1;
+
+  if(first == last)
+  {
+    return popcount64(row[first] & lowMask & highMask);
+  }
+
+  int total = popcount64(row[first] & lowMask);
+  for(int w=first + 1; w<last; w++)
+  {
+    total += popcount64(row[w]);
+  }
+  return total + popcount64(row[last] & highMask);
+}
+
+//Horizontal pass: AND/OR over a window of 2*radius+1 bits. The window is split
+//into [x-radius, x] and [x, x+radius], each built by doubling so it costs
+//O(log radius) word operations per word instead of O(radius).
+template<bool Erode> void ofxWebcamBinaryMask::horizontal(int radius)
+{
+  int length = radius + 1;
+  int power = 1;
+  while(power * 2 <= length) power *= 2;
+
+  uint64_t fill = Erode ? ~0ULL : 0ULL;
+  uint64_t tail = tailMask();
+
+  for(int y=0; y<height; y++)
+  {
+    uint64_t * row = getRow(y);
+
+    //Pixels past the width behave like the outside of the image.
+    if(Erode) row[wordsPerRow - 1] |= ~tail;
+
+    for(int pass=0; pass<2; pass++)
+    {
+      bool forward = pass == 0;
+      uint64_t * acc = forward ? &scratch[0] : &scratchBack[0];
+
+      //acc(x) = combine of row over [x, x+power-1] (or [x-power+1, x] going back)
+      std::copy(row, row + wordsPerRow, acc);
+      for(int span=1; span<power; span*=2)
+      {
+        if(forward) shiftRow(acc, &shifted[0], wordsPerRow, span, fill);
+        else shiftRowBack(acc, &shifted[0], wordsPerRow, span, fill);
+        for(int w=0; w<wordsPerRow; w++) acc[w] = combine<Erode>(acc[w], shifted[w]);
+      }
+
+      //Two overlapping power-of-two windows cover the whole half.
+      if(forward) shiftRow(acc, &shifted[0], wordsPerRow, length - power, fill);
+      else shiftRowBack(acc, &shifted[0], wordsPerRow, length - power, fill);
+      for(int w=0; w<wordsPerRow; w++) acc[w] = combine<Erode>(acc[w], shifted[w]);
+    }
+
+    for(int w=0; w<wordsPerRow; w++) row[w] = combine<Erode>(scratch[w], scratchBack[w]);
+    row[wordsPerRow - 1] &= tail;
+  }
+}
+
+//Vertical pass: van Herk/Gil-Werman. Rows are split into blocks of the window
+//length; a running prefix and suffix per block give any window with a single
+//extra operation, so the cost per word is constant whatever the radius.
+template<bool Erode> void ofxWebcamBinaryMask::vertical(int radius)
+{
+  int length = 2 * radius + 1;
+  int padded = height + 2 * radius;
+  uint64_t fill = Erode ? ~0ULL : 0ULL;
+  size_t n = wordsPerRow;
+
+  prefix.resize(n * padded);
+  suffix.resize(n * padded);
+
+  for(int p=0; p<padded; p++)
+  {
+    int y = p - radius;
+    const uint64_t * src = (y >= 0 && y < height) ? getRow(y) : NULL;
+    uint64_t * g = &prefix[n * p];
+    if(p % length == 0)
+    {
+      for(size_t w=0; w<n; w++) g[w] = src ? src[w] : fill;
+    }
+    else
+    {
+      const uint64_t * prev = &prefix[n * (p - 1)];
+      for(size_t w=0; w<n; w++) g[w] = combine<Erode>(prev[w], src ? src[w] : fill);
+    }
+  }
+
+  for(int p=padded-1; p>=0; p--)
+  {
+    int y = p - radius;
+    const uint64_t * src = (y >= 0 && y < height) ? getRow(y) : NULL;
+    uint64_t * h = &suffix[n * p];
+    if(p % length == length - 1 || p == padded - 1)
+    {
+      for(size_t w=0; w<n; w++) h[w] = src ? src[w] : fill;
+    }
+    else
+    {
+      const uint64_t * next = &suffix[n * (p + 1)];
+      for(size_t w=0; w<n; w++) h[w] = combine<Erode>(src ? src[w] : fill, next[w]);
+    }
+  }
+
+  uint64_t tail = tailMask();
+  for(int y=0; y<height; y++)
+  {
+    const uint64_t * h = &suffix[n * y];
+    const uint64_t * g = &prefix[n * (y + length - 1)];
+    uint64_t * row = getRow(y);
+    for(size_t w=0; w<n; w++) row[w] = combine<Erode>(h[w], g[w]);
+    row[n - 1] &= tail;
+  }
+}
+
+void ofxWebcamBinaryMask::erode(int radius)
+{
+  if(radius <= 0 || !isAllocated()) return;
+  horizontal<true>(radius);
+  vertical<true>(radius);
+}
+
+void ofxWebcamBinaryMask::dilate(int radius)
+{
+  if(radius <= 0 || !isAllocated()) return;
+  horizontal<false>(radius);
+  vertical<false>(radius);
+}
+
+void ofxWebcamBinaryMask::open(int radius)
+{
+  erode(radius);
+  dilate(radius);
+}
+
+void ofxWebcamBinaryMask::close(int radius)
+{
+  dilate(radius);
+  erode(radius);
+}
+
+void ofxWebcamBinaryMask::apply(ofxWebcamMorphology mode, int radius)
+{
+  switch(mode)
+  {
+    case OFX_WEBCAM_MORPHOLOGY_OPEN:
+      open(radius);
+      break;
+    case OFX_WEBCAM_MORPHOLOGY_CLOSE:
+      close(radius);
+      break;
+    case OFX_WEBCAM_MORPHOLOGY_OPEN_CLOSE:
+      open(radius);
+      close(radius);
+      break;
+    default:
+      break;
+  }
+}
+
+int ofxWebcamBinaryMask::getWidth()
+{
+  return width;
+}
+
+int ofxWebcamBinaryMask::getHeight()
+{
+  return height;
+}
+
+int ofxWebcamBinaryMask::getWordsPerRow()
+{
+  return wordsPerRow;
+}
+
+uint64_t * ofxWebcamBinaryMask::getRow(int y)
+{
+  return &bits[(size_t)y * wordsPerRow];
+}
+
+bool ofxWebcamBinaryMask::get(int x, int y)
+{
+  return (getRow(y)[x / 64] >> (x % 64)) & 1;
+}
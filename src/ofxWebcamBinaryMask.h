@@ -0,0 +1,64 @@
+#pragma once
+#include "ofMain.h"
+
+enum ofxWebcamMorphology {
+  OFX_WEBCAM_MORPHOLOGY_NONE = 0,
+  OFX_WEBCAM_MORPHOLOGY_OPEN,        //Removes specks smaller than the radius
+  OFX_WEBCAM_MORPHOLOGY_CLOSE,       //Joins fragments closer than the radius
+  OFX_WEBCAM_MORPHOLOGY_OPEN_CLOSE   //Both, in that order
+};
+
+//A horizontal run of foreground pixels, start and end inclusive.
+struct ofxWebcamRun {
+  int y;
+  int start;
+  int end;
+};
+
+//A binary image stored as 1 bit per pixel, 64 pixels per word.
+//Bit i of word w in a row is pixel w*64+i. Bits past the width are always 0.
+class ofxWebcamBinaryMask {
+  private:
+    int width;
+    int height;
+    int wordsPerRow;
+    vector<uint64_t> bits;
+
+    //Scratch rows reused by the morphology passes.
+    vector<uint64_t> scratch;
+    vector<uint64_t> scratchBack;
+    vector<uint64_t> prefix;
+    vector<uint64_t> suffix;
+    vector<uint64_t> shifted;
+
+    uint64_t tailMask();
+    template<bool Erode> void horizontal(int radius);
+    template<bool Erode> void vertical(int radius);
+
+  public:
+    ofxWebcamBinaryMask();
+    ~ofxWebcamBinaryMask();
+
+    void allocate(int w, int h);
+    bool isAllocated();
+    void clear();
+
+    void setFromPixels(const ofPixels & pix);
+    void setFromDifference(const ofPixels & image, const ofPixels & reference, float threshold);
+    void toPixels(ofPixels & pix);
+    void extractRuns(vector<ofxWebcamRun> & runs);
+    size_t count();
+    int count(int y, int start, int end);
+
+    void erode(int radius);
+    void dilate(int radius);
+    void open(int radius);
+    void close(int radius);
+    void apply(ofxWebcamMorphology mode, int radius);
+
+    int getWidth();
+    int getHeight();
+    int getWordsPerRow();
+    uint64_t * getRow(int y);
+    bool get(int x, int y);
+};
@@ -1,11 +1,22 @@
 #include "ofxWebcamBlob.h"
 
-ofxWebcamBlob::ofxWebcamBlob(int id, ofxCvBlob blob, float tolerance){
+//time is when the frame the blob was found in was captured, in seconds
+//on the ofGetElapsedTimef() clock; by default the current time.
+ofxWebcamBlob::ofxWebcamBlob(int id, ofxCvBlob blob, float tolerance, float time){
   this->blob = blob;
   this->active = true;
   this->tolerance = tolerance;
   this->id = id;
-  this->overlap = false;
+  this->trajectory = -1;
+  this->mergedInto = -1;
+  this->simplifiedTolerance = -1;
+  this->lastSeen = time < 0 ? ofGetElapsedTimef() : time;
+  this->lastUpdate = lastSeen;
+  this->previousCentroid = ofVec2f(blob.centroid.x, blob.centroid.y);
+  this->previousUpdate = lastSeen;
+  this->measuredCentroid = previousCentroid;
+  this->measuredUpdate = lastSeen;
+  this->flowValid = false;
   speed = 0;
 }
 
@@ -14,15 +25,160 @@ ofxWebcamBlob::~ofxWebcamBlob(){
 }
 
 void ofxWebcamBlob::update(ofxCvBlob blob)
+{
+  update(blob, ofGetElapsedTimef());
+}
+
+//direction is the step since the last update, velocity the step since the
+//last measured position in pixels per second of capture time, so frames in
+//between that were only extrapolated do not change it. With optical flow,
+//velocity comes from the flow instead of the centroid, which jumps when the
+//outline changes. A frame with the same capture time as the last one
+//keeps the last velocity.
+void ofxWebcamBlob::update(ofxCvBlob blob, float time)
 {
   direction.x = blob.centroid.x - this->blob.centroid.x;
   direction.y = blob.centroid.y - this->blob.centroid.y;
   direction.z = 0.0;
 
-  speed = direction.length();
+  ofVec2f centroid(blob.centroid.x, blob.centroid.y);
+  float dt = time - measuredUpdate;
+  if(dt > 0)
+  {
+    ofVec2f step = flowValid ? flow : centroid - measuredCentroid;
+    velocity = step / dt;
+  }
+  measuredCentroid = centroid;
+  measuredUpdate = time;
+  previousCentroid = ofVec2f(this->blob.centroid.x, this->blob.centroid.y);
+  previousUpdate = lastUpdate;
+  lastUpdate = time;
+  speed = velocity.length();
 
   this->blob = blob;
   this->active = true;
+  simplifiedTolerance = -1;
+}
+
+//Moves the blob one more step along its last direction without marking it
+//as seen. time is the frame's capture time; the blob's position is then
+//as of that time, so it is not carried along its velocity a second time.
+void ofxWebcamBlob::extrapolate(float time)
+{
+  previousCentroid = ofVec2f(blob.centroid.x, blob.centroid.y);
+  previousUpdate = lastUpdate;
+  lastUpdate = time;
+  translate(direction);
+}
+
+void ofxWebcamBlob::translate(ofVec3f delta)
+{
+  blob.centroid += delta;
+  blob.boundingRect.x += delta.x;
+  blob.boundingRect.y += delta.y;
+  for(size_t i=0; i<blob.pts.size(); i++)
+  {
+    blob.pts[i] += delta;
+  }
+  for(size_t i=0; i<hull.size(); i++)
+  {
+    hull[i] += delta;
+  }
+  simplifiedTolerance = -1;
+}
+
+void ofxWebcamBlob::setHull(const vector<ofPoint> & points)
+{
+  hull = points;
+}
+
+//Empty unless the tracker was asked for OFX_WEBCAM_BLOB_HULL.
+vector<ofPoint> & ofxWebcamBlob::getHull()
+{
+  return hull;
+}
+
+//Simplified on first access after each update and kept until the blob changes.
+//Empty unless the tracker was asked for OFX_WEBCAM_BLOB_CONTOUR.
+ofPolyline & ofxWebcamBlob::getSimplifiedContour(float tolerance)
+{
+  if(simplifiedTolerance != tolerance)
+  {
+    simplified.clear();
+    for(size_t i=0; i<blob.pts.size(); i++)
+    {
+      simplified.addVertex(blob.pts[i]);
+    }
+    simplified.close();
+    simplified.simplify(tolerance);
+    simplifiedTolerance = tolerance;
+  }
+  return simplified;
+}
+
+//This blob disappeared into host. It keeps its shape and area and is carried
+//along at the offset it had when the merge started.
+void ofxWebcamBlob::mergeInto(ofxWebcamBlob & host)
+{
+  mergedInto = host.id;
+  ofPoint hostBefore = host.blob.centroid - host.direction;
+  mergeOffset = blob.centroid - hostBefore;
+  host.members.push_back(id);
+}
+
+void ofxWebcamBlob::split(ofxWebcamBlob & host)
+{
+  host.removeMember(id);
+  mergedInto = -1;
+}
+
+//Inside a merge the blob's own flow, when there is one, still tells how
+//it moves, even though its position follows the host.
+void ofxWebcamBlob::follow(ofxWebcamBlob & host)
+{
+  ofVec3f delta = (host.blob.centroid + mergeOffset) - blob.centroid;
+  direction = delta;
+  float dt = host.lastUpdate - lastUpdate;
+  velocity = (flowValid && dt > 0) ? flow / dt : host.velocity;
+  previousCentroid = ofVec2f(blob.centroid.x, blob.centroid.y);
+  previousUpdate = lastUpdate;
+  lastUpdate = host.lastUpdate;
+  speed = velocity.length();
+  translate(delta);
+  measuredCentroid = ofVec2f(blob.centroid.x, blob.centroid.y);
+  measuredUpdate = lastUpdate;
+}
+
+void ofxWebcamBlob::removeMember(int memberId)
+{
+  members.erase(std::remove(members.begin(), members.end(), memberId), members.end());
+}
+
+ofPoint ofxWebcamBlob::getPredictedCentroid()
+{
+  return flowValid ? blob.centroid + ofPoint(flow.x, flow.y) : blob.centroid + direction;
+}
+
+//Step measured by optical flow from the last frame to the one being matched.
+void ofxWebcamBlob::setFlow(ofVec2f step)
+{
+  flow = step;
+  flowValid = true;
+}
+
+void ofxWebcamBlob::clearFlow()
+{
+  flowValid = false;
+}
+
+bool ofxWebcamBlob::hasFlow()
+{
+  return flowValid;
+}
+
+ofVec2f ofxWebcamBlob::getFlow()
+{
+  return flow;
 }
 
 bool ofxWebcamBlob::intersects(const ofxWebcamBlob otherBlob){
@@ -48,7 +204,7 @@ float ofxWebcamBlob::difference(ofxCvBlob otherBlob){
     return -1;
   }
 
-  ofVec3f expectedLocationDiff = (blob.centroid + direction) - otherBlob.centroid;
+  ofVec3f expectedLocationDiff = getPredictedCentroid() - otherBlob.centroid;
   float deviation = expectedLocationDiff.length();
   float areaDiff = abs(otherBlob.area - blob.area);
 
@@ -67,25 +223,55 @@ float ofxWebcamBlob::getTolerance()
   return tolerance;
 }
 
+#ifndef OFX_WEBCAM_TRACKER_HEADLESS
 void ofxWebcamBlob::draw(float x, float y){
   if(active)
   {
     blob.draw(x,y);
   }
 }
+#endif
 
 void ofxWebcamBlob::setActive(bool value)
+{
+  setActive(value, ofGetElapsedTimef());
+}
+
+void ofxWebcamBlob::setActive(bool value, float time)
 {
   active = value;
   if(active)
   {
-    lastSeen = ofGetElapsedTimef();
+    lastSeen = time;
   }
 }
 
-void ofxWebcamBlob::setOverlap(bool value)
+//Capture time of the frame this blob was last updated from.
+float ofxWebcamBlob::getCaptureTime()
+{
+  return lastUpdate;
+}
+
+//Where the blob was at the update before the last one, and when.
+ofVec2f ofxWebcamBlob::getPreviousCentroid()
+{
+  return previousCentroid;
+}
+
+float ofxWebcamBlob::getPreviousCaptureTime()
+{
+  return previousUpdate;
+}
+
+
+void ofxWebcamBlob::setTrajectory(int slot)
+{
+  trajectory = slot;
+}
+
+int ofxWebcamBlob::getTrajectory()
 {
-  overlap = value;
+  return trajectory;
 }
 
 bool ofxWebcamBlob::isActive()
@@ -95,10 +281,30 @@ bool ofxWebcamBlob::isActive()
 
 bool ofxWebcamBlob::isOverlapping()
 {
-  return overlap;
+  return mergedInto != -1 || !members.empty();
+}
+
+bool ofxWebcamBlob::isMerged()
+{
+  return mergedInto != -1;
+}
+
+int ofxWebcamBlob::getMergedInto()
+{
+  return mergedInto;
+}
+
+vector<int> & ofxWebcamBlob::getMembers()
+{
+  return members;
 }
 
 float ofxWebcamBlob::timeSinceLastSeen()
 {
-  return ofGetElapsedTimef() - lastSeen;
+  return timeSinceLastSeen(ofGetElapsedTimef());
+}
+
+float ofxWebcamBlob::timeSinceLastSeen(float now)
+{
+  return now - lastSeen;
 }
@@ -1,32 +1,75 @@
 #pragma once
 #include "ofxOpenCv.h"
+#include "ofxWebcamAppearance.h"
 
 class ofxWebcamBlob {
   private:
     float tolerance;
     bool active;
     float lastSeen;
-    bool overlap;
+    float lastUpdate;
+    ofVec2f previousCentroid;
+    float previousUpdate;
+    ofVec2f measuredCentroid;
+    float measuredUpdate;
+    int trajectory;
+    int mergedInto;
+    ofVec3f mergeOffset;
+    vector<int> members;
+    vector<ofPoint> hull;
+    ofPolyline simplified;
+    float simplifiedTolerance;
+    ofVec2f flow;
+    bool flowValid;
+
+    void translate(ofVec3f delta);
 
   public:
     int id;
     ofxCvBlob blob;
     ofVec3f direction;
+    ofVec2f velocity;
     float speed;
+    ofxWebcamAppearance appearance;
 
-    ofxWebcamBlob(int id, ofxCvBlob blob, float tolerance);
+    ofxWebcamBlob(int id, ofxCvBlob blob, float tolerance, float time=-1);
     ~ofxWebcamBlob();
 
     void update(ofxCvBlob blob);
+    void update(ofxCvBlob blob, float time);
+    void extrapolate(float time);
     bool intersects(ofxWebcamBlob otherBlob);
     ofRectangle getIntersection(ofxWebcamBlob otherBlob);
     float difference(ofxCvBlob otherBlob);
     void setTolerance(float value);
     float getTolerance();
+#ifndef OFX_WEBCAM_TRACKER_HEADLESS
     void draw(float x, float y);
+#endif
     void setActive(bool value);
-    void setOverlap(bool value);
+    void setActive(bool value, float time);
+    void mergeInto(ofxWebcamBlob & host);
+    void split(ofxWebcamBlob & host);
+    void follow(ofxWebcamBlob & host);
+    void removeMember(int memberId);
+    ofPoint getPredictedCentroid();
+    void setFlow(ofVec2f step);
+    void clearFlow();
+    bool hasFlow();
+    ofVec2f getFlow();
+    void setHull(const vector<ofPoint> & points);
+    vector<ofPoint> & getHull();
+    ofPolyline & getSimplifiedContour(float tolerance);
+    void setTrajectory(int slot);
+    int getTrajectory();
     bool isActive();
     bool isOverlapping();
+    bool isMerged();
+    int getMergedInto();
+    vector<int> & getMembers();
+    float getCaptureTime();
+    ofVec2f getPreviousCentroid();
+    float getPreviousCaptureTime();
     float timeSinceLastSeen();
+    float timeSinceLastSeen(float now);
 };
@@ -0,0 +1,75 @@
+#include "ofxWebcamBlobIndex.h"
+
+ofxWebcamBlobIndex::ofxWebcamBlobIndex() : cellSize(1), cols(1), rows(1) {
+
+}
+
+ofxWebcamBlobIndex::~ofxWebcamBlobIndex(){
+
+}
+
+int ofxWebcamBlobIndex::cellX(float x)
+{
+  return (int)ofClamp(floor(x / cellSize), 0, cols - 1);
+}
+
+int ofxWebcamBlobIndex::cellY(float y)
+{
+  return (int)ofClamp(floor(y / cellSize), 0, rows - 1);
+}
+
+void ofxWebcamBlobIndex::build(const vector<ofPoint> & points, float size, float width, float height)
+{
+  //Tiny cells would make the grid bigger than the blobs it indexes.
+  float minSize = sqrt(MAX(1.0f, width * height) / MAX_BLOB_INDEX_CELLS);
+  cellSize = MAX(MAX(1.0f, size), minSize);
+  cols = MAX(1, (int)ceil(width / cellSize));
+  rows = MAX(1, (int)ceil(height / cellSize));
+
+  cellStart.assign(cols * rows + 1, 0);
+  cellOf.resize(points.size());
+  for(size_t i=0; i<points.size(); i++)
+  {
+    cellOf[i] = cellY(points[i].y) * cols + cellX(points[i].x);
+    cellStart[cellOf[i] + 1]++;
+  }
+  for(int c=0; c<cols * rows; c++)
+  {
+    cellStart[c + 1] += cellStart[c];
+  }
+
+  entries.resize(points.size());
+  for(size_t i=0; i<points.size(); i++)
+  {
+    entries[cellStart[cellOf[i]]++] = i;
+  }
+  //The fill above advanced every start to the next cell's start, shift back.
+  for(int c=cols * rows; c>0; c--)
+  {
+    cellStart[c] = cellStart[c - 1];
+  }
+  cellStart[0] = 0;
+}
+
+//Appends (after clearing) every point whose cell is within radius of p.
+//Callers still check the exact distance.
+void ofxWebcamBlobIndex::query(const ofPoint & p, float radius, vector<int> & found)
+{
+  found.clear();
+  int x0 = cellX(p.x - radius);
+  int x1 = cellX(p.x + radius);
+  int y0 = cellY(p.y - radius);
+  int y1 = cellY(p.y + radius);
+
+  for(int cy=y0; cy<=y1; cy++)
+  {
+    for(int cx=x0; cx<=x1; cx++)
+    {
+      int c = cy * cols + cx;
+      for(int e=cellStart[c]; e<cellStart[c + 1]; e++)
+      {
+        found.push_back(entries[e]);
+      }
+    }
+  }
+}
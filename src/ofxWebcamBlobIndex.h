@@ -0,0 +1,27 @@
+#pragma once
+#include "ofMain.h"
+
+#define MAX_BLOB_INDEX_CELLS 4096
+
+//Uniform grid over points, rebuilt every frame with a counting sort.
+//Neighbour queries only look at the cells a radius touches, so matching
+//stays linear in the number of blobs as long as they are spread out.
+class ofxWebcamBlobIndex {
+  private:
+    float cellSize;
+    int cols;
+    int rows;
+    vector<int> cellStart;
+    vector<int> entries;
+    vector<int> cellOf;
+
+    int cellX(float x);
+    int cellY(float y);
+
+  public:
+    ofxWebcamBlobIndex();
+    ~ofxWebcamBlobIndex();
+
+    void build(const vector<ofPoint> & points, float cellSize, float width, float height);
+    void query(const ofPoint & p, float radius, vector<int> & found);
+};
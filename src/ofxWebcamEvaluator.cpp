@@ -0,0 +1,174 @@
+#include "ofxWebcamEvaluator.h"
+
+ofxWebcamEvaluator::ofxWebcamEvaluator(){
+  radius = DEFAULT_EVALUATOR_RADIUS;
+  reset();
+}
+
+ofxWebcamEvaluator::~ofxWebcamEvaluator(){
+
+}
+
+//How far a blob may be from a person to count as tracking it.
+void ofxWebcamEvaluator::setMatchRadius(float pixels)
+{
+  radius = MAX(0, pixels);
+}
+
+void ofxWebcamEvaluator::reset()
+{
+  lastMatch.clear();
+  frames = 0;
+  groundTruth = 0;
+  matches = 0;
+  misses = 0;
+  falsePositives = 0;
+  idSwitches = 0;
+  distanceSum = 0;
+  processingMillis = 0;
+}
+
+//Call once per processed frame with the scene's truth, the tracker's blobs
+//and the time the tracker took (getFrameTime()). Only active blobs and
+//visible people take part.
+void ofxWebcamEvaluator::addFrame(vector<ofxWebcamTruth> & truth, vector<ofxWebcamBlob> & blobs, float frameMillis)
+{
+  frames++;
+  processingMillis += frameMillis;
+
+  truthTaken.assign(truth.size(), false);
+  blobTaken.assign(blobs.size(), false);
+  float radius2 = radius * radius;
+  int visible = 0;
+
+  //Keep last frame's pairs that still hold.
+  for(size_t t=0; t<truth.size(); t++)
+  {
+    if(!truth[t].visible) continue;
+    visible++;
+
+    std::map<int, int>::iterator last = lastMatch.find(truth[t].id);
+    if(last == lastMatch.end()) continue;
+
+    for(size_t b=0; b<blobs.size(); b++)
+    {
+      if(blobs[b].id != last->second || blobTaken[b] || !blobs[b].isActive()) continue;
+      float d2 = truth[t].position.squareDistance(ofVec2f(blobs[b].blob.centroid.x, blobs[b].blob.centroid.y));
+      if(d2 <= radius2)
+      {
+        truthTaken[t] = true;
+        blobTaken[b] = true;
+        matches++;
+        distanceSum += sqrt(d2);
+      }
+      break;
+    }
+  }
+
+  candidates.clear();
+  for(size_t t=0; t<truth.size(); t++)
+  {
+    if(!truth[t].visible || truthTaken[t]) continue;
+    for(size_t b=0; b<blobs.size(); b++)
+    {
+      if(blobTaken[b] || !blobs[b].isActive()) continue;
+      float d2 = truth[t].position.squareDistance(ofVec2f(blobs[b].blob.centroid.x, blobs[b].blob.centroid.y));
+      if(d2 > radius2) continue;
+      Candidate c = {(float)sqrt(d2), (int)t, (int)b};
+      candidates.push_back(c);
+    }
+  }
+  std::sort(candidates.begin(), candidates.end(), [](const Candidate & a, const Candidate & b){
+    return a.distance < b.distance;
+  });
+
+  for(size_t c=0; c<candidates.size(); c++)
+  {
+    Candidate & m = candidates[c];
+    if(truthTaken[m.truth] || blobTaken[m.blob]) continue;
+    truthTaken[m.truth] = true;
+    blobTaken[m.blob] = true;
+    matches++;
+    distanceSum += m.distance;
+
+    int id = truth[m.truth].id;
+    std::map<int, int>::iterator last = lastMatch.find(id);
+    if(last != lastMatch.end() && last->second != blobs[m.blob].id)
+    {
+      idSwitches++;
+    }
+    lastMatch[id] = blobs[m.blob].id;
+  }
+
+  groundTruth += visible;
+  for(size_t t=0; t<truth.size(); t++)
+  {
+    if(truth[t].visible && !truthTaken[t]) misses++;
+  }
+  for(size_t b=0; b<blobs.size(); b++)
+  {
+    if(blobs[b].isActive() && !blobTaken[b]) falsePositives++;
+  }
+}
+
+//1 - (misses + false positives + id switches) / ground truth. Can go below 0.
+float ofxWebcamEvaluator::getMota()
+{
+  if(groundTruth == 0) return 0;
+  return 1.0 - (double)(misses + falsePositives + idSwitches) / groundTruth;
+}
+
+//Mean distance in pixels between matched people and blobs.
+float ofxWebcamEvaluator::getMotp()
+{
+  return matches > 0 ? distanceSum / matches : 0;
+}
+
+uint64_t ofxWebcamEvaluator::getFrames()
+{
+  return frames;
+}
+
+uint64_t ofxWebcamEvaluator::getGroundTruthCount()
+{
+  return groundTruth;
+}
+
+uint64_t ofxWebcamEvaluator::getMatches()
+{
+  return matches;
+}
+
+uint64_t ofxWebcamEvaluator::getMisses()
+{
+  return misses;
+}
+
+uint64_t ofxWebcamEvaluator::getFalsePositives()
+{
+  return falsePositives;
+}
+
+uint64_t ofxWebcamEvaluator::getIdSwitches()
+{
+  return idSwitches;
+}
+
+//Throughput of the tracker alone, from the frame times it reported.
+float ofxWebcamEvaluator::getFramesPerSecond()
+{
+  return processingMillis > 0 ? frames * 1000.0 / processingMillis : 0;
+}
+
+string ofxWebcamEvaluator::getSummary()
+{
+  std::ostringstream out;
+  out << "frames " << frames
+      << " mota " << getMota()
+      << " motp " << getMotp()
+      << " misses " << misses
+      << " false positives " << falsePositives
+      << " id switches " << idSwitches
+      << " fps " << getFramesPerSecond();
+  return out.str();
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include "ofMain.h"
+#include "ofxWebcamBlob.h"
+#include "ofxWebcamSyntheticScene.h"
+
+#define DEFAULT_EVALUATOR_RADIUS 30
+
+//Scores tracked blobs against ground truth with the CLEAR MOT metrics.
+//Each frame, people keep the blob they matched last time while it stays
+//within the match radius. The rest are paired greedily by distance.
+//A person matched to a different blob id than before counts as an id switch.
+class ofxWebcamEvaluator {
+  private:
+    struct Candidate {
+      float distance;
+      int truth;
+      int blob;
+    };
+
+    float radius;
+    std::map<int, int> lastMatch;
+    vector<bool> blobTaken;
+    vector<bool> truthTaken;
+    vector<Candidate> candidates;
+
+    uint64_t frames;
+    uint64_t groundTruth;
+    uint64_t matches;
+    uint64_t misses;
+    uint64_t falsePositives;
+    uint64_t idSwitches;
+    double distanceSum;
+    double processingMillis;
+
+  public:
+    ofxWebcamEvaluator();
+    ~ofxWebcamEvaluator();
+
+    void setMatchRadius(float pixels);
+    void reset();
+    void addFrame(vector<ofxWebcamTruth> & truth, vector<ofxWebcamBlob> & blobs, float frameMillis);
+
+    float getMota();
+    float getMotp();
+    uint64_t getFrames();
+    uint64_t getGroundTruthCount();
+    uint64_t getMatches();
+    uint64_t getMisses();
+    uint64_t getFalsePositives();
+    uint64_t getIdSwitches();
+    float getFramesPerSecond();
+    string getSummary();
+};
@@ -0,0 +1,93 @@
+#pragma once
+#include "ofMain.h"
+
+#define DEFAULT_EVENT_QUEUE_SIZE 1024
+
+enum ofxWebcamBlobEventType {
+  OFX_WEBCAM_BLOB_ENTERED = 0,   //A new id was assigned
+  OFX_WEBCAM_BLOB_MOVED,         //A tracked blob was matched again this frame
+  OFX_WEBCAM_BLOB_LOST,          //A blob was not seen this frame, it is kept for a while
+  OFX_WEBCAM_BLOB_REMOVED,       //A blob was dropped, its id only comes back through reidentification
+  OFX_WEBCAM_BLOB_OVERLAP_BEGAN,
+  OFX_WEBCAM_BLOB_OVERLAP_ENDED
+};
+
+//Delivery modes, can be combined.
+enum ofxWebcamEventDelivery {
+  OFX_WEBCAM_EVENTS_NONE = 0,
+  OFX_WEBCAM_EVENTS_SYNC = 1,    //ofEvents fired from update() at the end of the frame
+  OFX_WEBCAM_EVENTS_QUEUE = 2    //Pushed to a lock-free queue for a consumer thread
+};
+
+struct ofxWebcamBlobEvent {
+  ofxWebcamBlobEventType type;
+  int id;
+  int otherId;
+  ofPoint centroid;
+  ofRectangle boundingRect;
+  float time;
+  int frame;
+};
+
+//Single producer, single consumer ring. The tracker pushes from update(),
+//one other thread pops. Events that do not fit are dropped and counted.
+template<typename T>
+class ofxWebcamEventQueue {
+  private:
+    vector<T> items;
+    size_t capacity;
+    std::atomic<size_t> head;
+    std::atomic<size_t> tail;
+    std::atomic<size_t> dropped;
+
+  public:
+    ofxWebcamEventQueue(size_t size=DEFAULT_EVENT_QUEUE_SIZE) : head(0), tail(0), dropped(0) {
+      setup(size);
+    }
+
+    //Not thread safe, call before the consumer starts.
+    void setup(size_t size)
+    {
+      capacity = MAX((size_t)2, size);
+      items.resize(capacity);
+      head.store(0);
+      tail.store(0);
+      dropped.store(0);
+    }
+
+    bool push(const T & item)
+    {
+      size_t t = tail.load(std::memory_order_relaxed);
+      size_t next = (t + 1) % capacity;
+      if(next == head.load(std::memory_order_acquire))
+      {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+      }
+      items[t] = item;
+      tail.store(next, std::memory_order_release);
+      return true;
+    }
+
+    bool pop(T & item)
+    {
+      size_t h = head.load(std::memory_order_relaxed);
+      if(h == tail.load(std::memory_order_acquire))
+      {
+        return false;
+      }
+      item = items[h];
+      head.store((h + 1) % capacity, std::memory_order_release);
+      return true;
+    }
+
+    bool empty()
+    {
+      return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+    }
+
+    size_t getDropped()
+    {
+      return dropped.load(std::memory_order_relaxed);
+    }
+};
@@ -0,0 +1,354 @@
+#include "ofxWebcamFlow.h"
+
+#define FLOW_MAX_WINDOW 7
+
+static inline float sample(const vector<float> & data, int width, int height, float x, float y)
+{
+  x = ofClamp(x, 0, width - 1.001f);
+  y = ofClamp(y, 0, height - 1.001f);
+  int ix = (int)x;
+  int iy = (int)y;
+  float fx = x - ix;
+  float fy = y - iy;
+  const float * p = &data[iy * width + ix];
+  float top = p[0] + (p[1] - p[0]) * fx;
+  float bottom = p[width] + (p[width + 1] - p[width]) * fx;
+  return top + (bottom - top) * fy;
+}
+
+ofxWebcamFlow::ofxWebcamFlow() : width(0), height(0), maxPoints(DEFAULT_FLOW_POINTS), window(DEFAULT_FLOW_WINDOW), levels(DEFAULT_FLOW_LEVELS), iterations(DEFAULT_FLOW_ITERATIONS), tileCols(0), stamp(1) {
+
+}
+
+ofxWebcamFlow::~ofxWebcamFlow(){
+
+}
+
+void ofxWebcamFlow::setup(int width, int height)
+{
+  this->width = width;
+  this->height = height;
+  previous.allocate(width, height, OF_PIXELS_GRAY);
+  tileCols = (width + FLOW_TILE_SIZE - 1) / FLOW_TILE_SIZE;
+  int tileRows = (height + FLOW_TILE_SIZE - 1) / FLOW_TILE_SIZE;
+  tileStamps.assign(tileCols * tileRows, 0);
+  stamp = 1;
+}
+
+bool ofxWebcamFlow::isAllocated()
+{
+  return !tileStamps.empty();
+}
+
+int ofxWebcamFlow::getWidth()
+{
+  return width;
+}
+
+int ofxWebcamFlow::getHeight()
+{
+  return height;
+}
+
+//Corners followed per region; the median of their steps is the result.
+void ofxWebcamFlow::setMaxPoints(int value)
+{
+  maxPoints = MAX(3, value);
+}
+
+//Half size of the window each corner is matched over.
+void ofxWebcamFlow::setWindow(int radius)
+{
+  window = ofClamp(radius, 1, FLOW_MAX_WINDOW);
+}
+
+//Pyramid levels. Each one doubles the largest step that can be followed.
+void ofxWebcamFlow::setLevels(int value)
+{
+  levels = ofClamp(value, 1, 5);
+}
+
+int ofxWebcamFlow::getMaxPoints()
+{
+  return maxPoints;
+}
+
+int ofxWebcamFlow::getWindow()
+{
+  return window;
+}
+
+int ofxWebcamFlow::getLevels()
+{
+  return levels;
+}
+
+//How far around a region pixels are needed: the largest step the pyramid
+//can follow plus the matching window.
+int ofxWebcamFlow::getMargin()
+{
+  return window * (1 << levels) + 2;
+}
+
+bool ofxWebcamFlow::isRemembered(int x0, int y0, int x1, int y1)
+{
+  for(int ty=y0 / FLOW_TILE_SIZE; ty<=(y1 - 1) / FLOW_TILE_SIZE; ty++)
+  {
+    for(int tx=x0 / FLOW_TILE_SIZE; tx<=(x1 - 1) / FLOW_TILE_SIZE; tx++)
+    {
+      if(tileStamps[ty * tileCols + tx] != stamp - 1) return false;
+    }
+  }
+  return true;
+}
+
+//Level 0 is the crop itself, every level above it half the size of the one
+//below. Levels too small to hold a matching window are left out.
+void ofxWebcamFlow::buildPyramid(const unsigned char * pixels, int x0, int y0, int w, int h, vector<Level> & pyramid)
+{
+  pyramid.resize(levels);
+  Level & base = pyramid[0];
+  base.width = w;
+  base.height = h;
+  base.data.resize(w * h);
+  for(int y=0; y<h; y++)
+  {
+    const unsigned char * line = pixels + (size_t)(y0 + y) * width + x0;
+    float * out = &base.data[y * w];
+    for(int x=0; x<w; x++) out[x] = line[x];
+  }
+
+  int built = 1;
+  for(int l=1; l<levels; l++)
+  {
+    const Level & below = pyramid[l - 1];
+    int lw = below.width / 2;
+    int lh = below.height / 2;
+    if(lw < 2 * window + 3 || lh < 2 * window + 3) break;
+
+    Level & level = pyramid[l];
+    level.width = lw;
+    level.height = lh;
+    level.data.resize(lw * lh);
+    for(int y=0; y<lh; y++)
+    {
+      const float * a = &below.data[(2 * y) * below.width];
+      const float * b = a + below.width;
+      float * out = &level.data[y * lw];
+      for(int x=0; x<lw; x++)
+      {
+        out[x] = (a[2*x] + a[2*x + 1] + b[2*x] + b[2*x + 1]) * 0.25f;
+      }
+    }
+    built++;
+  }
+  pyramid.resize(built);
+}
+
+//Scores a grid of points in the rectangle by the smaller eigenvalue of their
+//gradient matrix (Shi-Tomasi) and keeps the strongest maxPoints.
+void ofxWebcamFlow::findCorners(const Level & level, int x0, int y0, int x1, int y1)
+{
+  corners.clear();
+  x0 = MAX(x0, window + 1);
+  y0 = MAX(y0, window + 1);
+  x1 = MIN(x1, level.width - window - 1);
+  y1 = MIN(y1, level.height - window - 1);
+  if(x1 <= x0 || y1 <= y0) return;
+
+  int step = MAX(2, (int)sqrt((float)(x1 - x0) * (y1 - y0) / (maxPoints * 4)));
+  const float * d = &level.data[0];
+  int w = level.width;
+  float best = 0;
+
+  for(int y=y0 + step/2; y<y1; y+=step)
+  {
+    for(int x=x0 + step/2; x<x1; x+=step)
+    {
+      float gxx = 0, gxy = 0, gyy = 0;
+      for(int wy=-window; wy<=window; wy++)
+      {
+        const float * p = d + (y + wy) * w + x;
+        for(int wx=-window; wx<=window; wx++)
+        {
+          float ix = (p[wx + 1] - p[wx - 1]) * 0.5f;
+          float iy = (p[wx + w] - p[wx - w]) * 0.5f;
+          gxx += ix * ix;
+          gxy += ix * iy;
+          gyy += iy * iy;
+        }
+      }
+      float half = (gxx - gyy) * 0.5f;
+      float score = (gxx + gyy) * 0.5f - sqrt(half * half + gxy * gxy);
+      if(score > 0)
+      {
+        corners.push_back(make_pair(score, ofVec2f(x, y)));
+        best = MAX(best, score);
+      }
+    }
+  }
+
+  //Flat areas give steps that are mostly noise.
+  float minScore = best * 0.05f;
+  corners.erase(std::remove_if(corners.begin(), corners.end(), [minScore](const pair<float, ofVec2f> & c){
+    return c.first < minScore;
+  }), corners.end());
+
+  if((int)corners.size() > maxPoints)
+  {
+    std::nth_element(corners.begin(), corners.begin() + maxPoints, corners.end(), [](const pair<float, ofVec2f> & a, const pair<float, ofVec2f> & b){
+      return a.first > b.first;
+    });
+    corners.resize(maxPoints);
+  }
+}
+
+//Follows one point from the top of the pyramid down, refining the step
+//with a few Gauss-Newton iterations per level.
+bool ofxWebcamFlow::trackPoint(ofVec2f point, ofVec2f & displacement)
+{
+  const int size = 2 * window + 1;
+  float valueBuffer[(2 * FLOW_MAX_WINDOW + 1) * (2 * FLOW_MAX_WINDOW + 1)];
+  float gradXBuffer[(2 * FLOW_MAX_WINDOW + 1) * (2 * FLOW_MAX_WINDOW + 1)];
+  float gradYBuffer[(2 * FLOW_MAX_WINDOW + 1) * (2 * FLOW_MAX_WINDOW + 1)];
+
+  ofVec2f guess(0, 0);
+  for(int l=(int)previousPyramid.size() - 1; l>=0; l--)
+  {
+    const Level & I = previousPyramid[l];
+    const Level & J = currentPyramid[l];
+    ofVec2f p = point / (float)(1 << l);
+
+    float gxx = 0, gxy = 0, gyy = 0;
+    for(int wy=0; wy<size; wy++)
+    {
+      for(int wx=0; wx<size; wx++)
+      {
+        float x = p.x + wx - window;
+        float y = p.y + wy - window;
+        int k = wy * size + wx;
+        valueBuffer[k] = sample(I.data, I.width, I.height, x, y);
+        gradXBuffer[k] = (sample(I.data, I.width, I.height, x + 1, y) - sample(I.data, I.width, I.height, x - 1, y)) * 0.5f;
+        gradYBuffer[k] = (sample(I.data, I.width, I.height, x, y + 1) - sample(I.data, I.width, I.height, x, y - 1)) * 0.5f;
+        gxx += gradXBuffer[k] * gradXBuffer[k];
+        gxy += gradXBuffer[k] * gradYBuffer[k];
+        gyy += gradYBuffer[k] * gradYBuffer[k];
+      }
+    }
+
+    float det = gxx * gyy - gxy * gxy;
+    if(det < 1e-3f) return false;
+
+    ofVec2f v(0, 0);
+    for(int i=0; i<iterations; i++)
+    {
+      float bx = 0, by = 0;
+      ofVec2f q = p + guess + v;
+      for(int wy=0; wy<size; wy++)
+      {
+        for(int wx=0; wx<size; wx++)
+        {
+          int k = wy * size + wx;
+          float diff = valueBuffer[k] - sample(J.data, J.width, J.height, q.x + wx - window, q.y + wy - window);
+          bx += diff * gradXBuffer[k];
+          by += diff * gradYBuffer[k];
+        }
+      }
+      ofVec2f dv((gyy * bx - gxy * by) / det, (gxx * by - gxy * bx) / det);
+      v += dv;
+      if(dv.x * dv.x + dv.y * dv.y < 0.0009f) break;
+    }
+
+    if(l > 0)
+    {
+      guess = (guess + v) * 2;
+    }
+    else
+    {
+      displacement = guess + v;
+    }
+  }
+
+  ofVec2f end = point + displacement;
+  const Level & base = currentPyramid[0];
+  return end.x >= 0 && end.y >= 0 && end.x < base.width && end.y < base.height;
+}
+
+//The median step of the corners in region, in pixels from the previous frame
+//to current. False if the region was not remembered last frame or has too
+//little texture to follow.
+bool ofxWebcamFlow::track(const ofPixels & current, const ofRectangle & region, ofVec2f & displacement)
+{
+  if(!isAllocated() || (int)current.getWidth() != width || (int)current.getHeight() != height) return false;
+  if(region.width <= 0 || region.height <= 0) return false;
+
+  int margin = getMargin();
+  int x0 = MAX(0, (int)floor(region.x) - margin);
+  int y0 = MAX(0, (int)floor(region.y) - margin);
+  int x1 = MIN(width, (int)ceil(region.x + region.width) + margin);
+  int y1 = MIN(height, (int)ceil(region.y + region.height) + margin);
+  if(x1 - x0 < 2 * window + 3 || y1 - y0 < 2 * window + 3) return false;
+  if(!isRemembered(x0, y0, x1, y1)) return false;
+
+  buildPyramid(previous.getData(), x0, y0, x1 - x0, y1 - y0, previousPyramid);
+  buildPyramid(current.getData(), x0, y0, x1 - x0, y1 - y0, currentPyramid);
+
+  findCorners(previousPyramid[0], (int)region.x - x0, (int)region.y - y0, (int)(region.x + region.width) - x0, (int)(region.y + region.height) - y0);
+
+  stepX.clear();
+  stepY.clear();
+  for(size_t i=0; i<corners.size(); i++)
+  {
+    ofVec2f step;
+    if(trackPoint(corners[i].second, step))
+    {
+      stepX.push_back(step.x);
+      stepY.push_back(step.y);
+    }
+  }
+  if(stepX.size() < 3) return false;
+
+  size_t mid = stepX.size() / 2;
+  std::nth_element(stepX.begin(), stepX.begin() + mid, stepX.end());
+  std::nth_element(stepY.begin(), stepY.begin() + mid, stepY.end());
+  displacement = ofVec2f(stepX[mid], stepY[mid]);
+  return true;
+}
+
+//Keeps the pixels around region, rounded out to whole tiles, for the next
+//frame's track().
+void ofxWebcamFlow::remember(const ofPixels & current, const ofRectangle & region)
+{
+  if(!isAllocated() || (int)current.getWidth() != width || (int)current.getHeight() != height) return;
+  if(region.width <= 0 || region.height <= 0) return;
+
+  int margin = getMargin();
+  int tx0 = MAX(0, (int)floor(region.x) - margin) / FLOW_TILE_SIZE;
+  int ty0 = MAX(0, (int)floor(region.y) - margin) / FLOW_TILE_SIZE;
+  int tx1 = (MIN(width, (int)ceil(region.x + region.width) + margin) - 1) / FLOW_TILE_SIZE;
+  int ty1 = (MIN(height, (int)ceil(region.y + region.height) + margin) - 1) / FLOW_TILE_SIZE;
+  if(tx1 < tx0 || ty1 < ty0) return;
+
+  int x0 = tx0 * FLOW_TILE_SIZE;
+  int x1 = MIN(width, (tx1 + 1) * FLOW_TILE_SIZE);
+  int y1 = MIN(height, (ty1 + 1) * FLOW_TILE_SIZE);
+  const unsigned char * src = current.getData();
+  unsigned char * dst = previous.getData();
+  for(int y=ty0 * FLOW_TILE_SIZE; y<y1; y++)
+  {
+    memcpy(dst + (size_t)y * width + x0, src + (size_t)y * width + x0, x1 - x0);
+  }
+
+  for(int ty=ty0; ty<=ty1; ty++)
+  {
+    for(int tx=tx0; tx<=tx1; tx++)
+    {
+      tileStamps[ty * tileCols + tx] = stamp;
+    }
+  }
+}
+
+void ofxWebcamFlow::nextFrame()
+{
+  stamp++;
+}
@@ -0,0 +1,67 @@
+#pragma once
+#include "ofMain.h"
+
+#define DEFAULT_FLOW_POINTS 24
+#define DEFAULT_FLOW_WINDOW 4
+#define DEFAULT_FLOW_LEVELS 3
+#define DEFAULT_FLOW_ITERATIONS 8
+#define FLOW_TILE_SIZE 16
+
+//Pyramidal Lucas-Kanade flow for single regions of the grayscale image.
+//track() picks corners inside a region of the previous frame and follows
+//them into the current one, returning their median displacement. Only the
+//region and a margin around it are ever read or copied, so the cost grows
+//with the size of the region and not with the frame.
+//
+//The previous frame is kept only where remember() was called. Each frame:
+//track() every region, remember() where they are now, then nextFrame().
+class ofxWebcamFlow {
+  private:
+    struct Level {
+      vector<float> data;
+      int width;
+      int height;
+    };
+
+    int width;
+    int height;
+    int maxPoints;
+    int window;
+    int levels;
+    int iterations;
+    ofPixels previous;
+    vector<uint32_t> tileStamps;
+    int tileCols;
+    uint32_t stamp;
+
+    vector<Level> previousPyramid;
+    vector<Level> currentPyramid;
+    vector<pair<float, ofVec2f> > corners;
+    vector<float> stepX;
+    vector<float> stepY;
+
+    int getMargin();
+    bool isRemembered(int x0, int y0, int x1, int y1);
+    void buildPyramid(const unsigned char * pixels, int x0, int y0, int w, int h, vector<Level> & pyramid);
+    void findCorners(const Level & level, int x0, int y0, int x1, int y1);
+    bool trackPoint(ofVec2f point, ofVec2f & displacement);
+
+  public:
+    ofxWebcamFlow();
+    ~ofxWebcamFlow();
+
+    void setup(int width, int height);
+    bool isAllocated();
+    int getWidth();
+    int getHeight();
+    void setMaxPoints(int value);
+    void setWindow(int radius);
+    void setLevels(int value);
+    int getMaxPoints();
+    int getWindow();
+    int getLevels();
+
+    bool track(const ofPixels & current, const ofRectangle & region, ofVec2f & displacement);
+    void remember(const ofPixels & current, const ofRectangle & region);
+    void nextFrame();
+};
@@ -0,0 +1,64 @@
+#pragma once
+#include "ofMain.h"
+
+//A stitched frame as published by ofxWebcamArray. The pixels are shared by
+//every tracker reading the frame and must not be modified; the buffer goes
+//back to the array's pool when the last reader lets go of it.
+struct ofxWebcamFrame {
+  shared_ptr<ofPixels> pixels;
+  //Set instead of pixels when the array ingests luma only.
+  shared_ptr<ofPixels> luma;
+  uint64_t number;
+  //When the oldest camera image in the frame was captured, in
+  //ofGetElapsedTimeMicros() time.
+  uint64_t captureTime;
+  //Comes from simulated sources, so captureTime is on their clock.
+  bool simulated;
+
+  ofxWebcamFrame() : number(0), captureTime(0), simulated(false) {
+  }
+};
+
+//Recycles frame buffers so publishing a frame does not allocate once the
+//pool holds as many buffers as there are frames in flight.
+class ofxWebcamFramePool : public std::enable_shared_from_this<ofxWebcamFramePool> {
+  private:
+    std::mutex mutex;
+    vector<ofPixels *> available;
+
+    void recycle(ofPixels * pixels)
+    {
+      std::lock_guard<std::mutex> guard(mutex);
+      available.push_back(pixels);
+    }
+
+  public:
+    ~ofxWebcamFramePool()
+    {
+      for(size_t i=0; i<available.size(); i++)
+      {
+        delete available[i];
+      }
+    }
+
+    shared_ptr<ofPixels> acquire()
+    {
+      ofPixels * pixels = NULL;
+      {
+        std::lock_guard<std::mutex> guard(mutex);
+        if(!available.empty())
+        {
+          pixels = available.back();
+          available.pop_back();
+        }
+      }
+      if(pixels == NULL)
+      {
+        pixels = new ofPixels();
+      }
+
+      //The deleter keeps the pool alive until every buffer has come back.
+      shared_ptr<ofxWebcamFramePool> self = shared_from_this();
+      return shared_ptr<ofPixels>(pixels, [self](ofPixels * p){ self->recycle(p); });
+    }
+};
@@ -0,0 +1,214 @@
+#include "ofxWebcamFrameSource.h"
+
+//With nativeFormat the camera is asked for whatever it delivers without
+//conversion, falling back to grayscale, for the luma ingest path.
+ofxWebcamGrabberSource::ofxWebcamGrabberSource(int deviceId, bool useTexture, bool nativeFormat){
+  this->deviceId = deviceId;
+  this->useTexture = useTexture;
+  this->nativeFormat = nativeFormat;
+}
+
+//May run on a thread of its own, so the grabber opens without a texture.
+//It allocates one on the main thread in its first update() after that.
+bool ofxWebcamGrabberSource::setup(int width, int height)
+{
+  grabber.setUseTexture(false);
+  grabber.setDeviceID(deviceId);
+  if(nativeFormat && !grabber.setPixelFormat(OF_PIXELS_NATIVE))
+  {
+    grabber.setPixelFormat(OF_PIXELS_GRAY);
+  }
+  bool opened = grabber.setup(width, height);
+  grabber.setUseTexture(useTexture);
+  return opened;
+}
+
+void ofxWebcamGrabberSource::update()
+{
+  grabber.update();
+}
+
+bool ofxWebcamGrabberSource::isFrameNew()
+{
+  return grabber.isFrameNew();
+}
+
+ofPixels & ofxWebcamGrabberSource::getPixels()
+{
+  return grabber.getPixels();
+}
+
+ofPixelFormat ofxWebcamGrabberSource::getPixelFormat()
+{
+  return grabber.getPixelFormat();
+}
+
+void ofxWebcamGrabberSource::close()
+{
+  grabber.close();
+}
+
+bool ofxWebcamGrabberSource::isInitialized()
+{
+  return grabber.isInitialized();
+}
+
+#ifndef OFX_WEBCAM_TRACKER_HEADLESS
+bool ofxWebcamGrabberSource::canDraw()
+{
+  return useTexture;
+}
+
+void ofxWebcamGrabberSource::draw(float x, float y)
+{
+  grabber.draw(x, y);
+}
+#endif
+
+ofVideoGrabber & ofxWebcamGrabberSource::getGrabber()
+{
+  return grabber;
+}
+
+ofxWebcamVideoSource::ofxWebcamVideoSource(string path, float fps){
+  this->path = path;
+  this->requestedFps = fps;
+  this->fps = fps > 0 ? fps : DEFAULT_VIDEO_FPS;
+  delivered = -1;
+  totalFrames = 0;
+  misses = 0;
+  fresh = false;
+  finished = false;
+}
+
+//The file is stitched at its own size, cropped to width x height.
+bool ofxWebcamVideoSource::setup(int width, int height)
+{
+  player.setUseTexture(false);
+  if(!player.load(path))
+  {
+    ofLogError("ofxWebcamVideoSource") << "Could not load " << path;
+    return false;
+  }
+  player.setLoopState(OF_LOOP_NONE);
+  player.play();
+  player.setPaused(true);
+  player.firstFrame();
+
+  if(requestedFps <= 0 && player.getDuration() > 0 && player.getTotalNumFrames() > 0)
+  {
+    fps = player.getTotalNumFrames() / player.getDuration();
+  }
+  totalFrames = player.getTotalNumFrames();
+  delivered = -1;
+  misses = 0;
+  fresh = false;
+  finished = false;
+  return true;
+}
+
+//Decoders may need a few updates to land on the next frame. One that never
+//does is given up on after DEFAULT_VIDEO_MAX_MISSES updates.
+void ofxWebcamVideoSource::update()
+{
+  fresh = false;
+  if(finished || !player.isLoaded()) return;
+
+  if(delivered >= 0 && misses == 0)
+  {
+    player.nextFrame();
+  }
+  player.update();
+
+  int frame = player.getCurrentFrame();
+  if(frame > delivered && player.getPixels().isAllocated())
+  {
+    delivered = frame;
+    misses = 0;
+    fresh = true;
+  }
+  else if(++misses > DEFAULT_VIDEO_MAX_MISSES)
+  {
+    ofLogWarning("ofxWebcamVideoSource") << path << " stopped decoding at frame " << delivered;
+    finished = true;
+  }
+
+  if((totalFrames > 0 && delivered >= totalFrames - 1) || (!fresh && player.getIsMovieDone()))
+  {
+    finished = true;
+  }
+}
+
+bool ofxWebcamVideoSource::isFrameNew()
+{
+  return fresh;
+}
+
+ofPixels & ofxWebcamVideoSource::getPixels()
+{
+  return player.getPixels();
+}
+
+ofPixelFormat ofxWebcamVideoSource::getPixelFormat()
+{
+  return player.getPixelFormat();
+}
+
+//A recording is played once: closed part way, for instance by the array's
+//stall watchdog, it counts as finished rather than starting over.
+void ofxWebcamVideoSource::close()
+{
+  player.close();
+  if(delivered >= 0)
+  {
+    finished = true;
+  }
+}
+
+bool ofxWebcamVideoSource::isInitialized()
+{
+  return player.isLoaded();
+}
+
+//One frame period after the start for the first frame, never 0.
+uint64_t ofxWebcamVideoSource::getCaptureTime()
+{
+  return delivered < 0 ? 0 : (uint64_t)((delivered + 1) * 1000000.0 / fps);
+}
+
+bool ofxWebcamVideoSource::isSimulated()
+{
+  return true;
+}
+
+//True once the last frame was delivered or the recording was closed.
+bool ofxWebcamVideoSource::isFinished()
+{
+  return finished;
+}
+
+int ofxWebcamVideoSource::getFrame()
+{
+  return delivered;
+}
+
+//0 when the file does not say.
+int ofxWebcamVideoSource::getTotalFrames()
+{
+  return totalFrames;
+}
+
+float ofxWebcamVideoSource::getFps()
+{
+  return fps;
+}
+
+string ofxWebcamVideoSource::getPath()
+{
+  return path;
+}
+
+ofVideoPlayer & ofxWebcamVideoSource::getPlayer()
+{
+  return player;
+}
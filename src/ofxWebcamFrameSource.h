@@ -0,0 +1,102 @@
+#pragma once
+#include "ofMain.h"
+
+#define DEFAULT_VIDEO_FPS 30
+#define DEFAULT_VIDEO_MAX_MISSES 100
+
+//Anything ofxWebcamArray can stitch: a camera, a recording, a generator.
+class ofxWebcamFrameSource {
+  public:
+    virtual ~ofxWebcamFrameSource(){}
+
+    //Called again after close() to reopen a source that failed. Cameras
+    //are set up on a thread of their own.
+    virtual bool setup(int width, int height) = 0;
+    virtual void update() = 0;
+    virtual bool isFrameNew() = 0;
+    virtual ofPixels & getPixels() = 0;
+    virtual ofPixelFormat getPixelFormat() = 0;
+    virtual void close() = 0;
+    virtual bool isInitialized() = 0;
+
+    //When the current image was captured, in ofGetElapsedTimeMicros() time
+    //for live sources. 0 lets the array stamp it on arrival.
+    virtual uint64_t getCaptureTime() { return 0; }
+
+    //Simulated sources run on their own clock and produce a frame every
+    //time they are updated, independent of the app's frame rate.
+    virtual bool isSimulated() { return false; }
+
+    //Recordings that have played to the end. They are never taken for
+    //stalled and reopened.
+    virtual bool isFinished() { return false; }
+
+#ifndef OFX_WEBCAM_TRACKER_HEADLESS
+    //Sources that cannot draw themselves are always stitched on the CPU.
+    virtual bool canDraw() { return false; }
+    virtual void draw(float, float) {}
+#endif
+};
+
+//A webcam through ofVideoGrabber.
+class ofxWebcamGrabberSource : public ofxWebcamFrameSource {
+  private:
+    ofVideoGrabber grabber;
+    int deviceId;
+    bool useTexture;
+    bool nativeFormat;
+
+  public:
+    ofxWebcamGrabberSource(int deviceId, bool useTexture=true, bool nativeFormat=false);
+
+    bool setup(int width, int height);
+    void update();
+    bool isFrameNew();
+    ofPixels & getPixels();
+    ofPixelFormat getPixelFormat();
+    void close();
+    bool isInitialized();
+#ifndef OFX_WEBCAM_TRACKER_HEADLESS
+    bool canDraw();
+    void draw(float x, float y);
+#endif
+
+    ofVideoGrabber & getGrabber();
+};
+
+//A recorded camera through ofVideoPlayer, stepped one frame per update()
+//as fast as it is called. Capture times come from the frame number and the
+//file's frame rate (or fps, if given), so a recording always plays back on
+//the same clock however fast the machine is.
+class ofxWebcamVideoSource : public ofxWebcamFrameSource {
+  private:
+    ofVideoPlayer player;
+    string path;
+    float fps;
+    float requestedFps;
+    int delivered;
+    int totalFrames;
+    int misses;
+    bool fresh;
+    bool finished;
+
+  public:
+    ofxWebcamVideoSource(string path, float fps=0);
+
+    bool setup(int width, int height);
+    void update();
+    bool isFrameNew();
+    ofPixels & getPixels();
+    ofPixelFormat getPixelFormat();
+    void close();
+    bool isInitialized();
+    uint64_t getCaptureTime();
+    bool isSimulated();
+
+    bool isFinished();
+    int getFrame();
+    int getTotalFrames();
+    float getFps();
+    string getPath();
+    ofVideoPlayer & getPlayer();
+};
@@ -0,0 +1,137 @@
+#include "ofxWebcamGovernor.h"
+
+ofxWebcamGovernor::ofxWebcamGovernor(){
+  target = 0;
+  smoothing = 0.9;
+  recoverRatio = 0.6;
+  reset();
+}
+
+ofxWebcamGovernor::~ofxWebcamGovernor(){
+
+}
+
+void ofxWebcamGovernor::update(float frameMillis)
+{
+  lastTime = frameMillis;
+  if(smoothedTime == 0)
+  {
+    smoothedTime = frameMillis;
+  }
+  else
+  {
+    smoothedTime = smoothedTime * smoothing + frameMillis * (1.0 - smoothing);
+  }
+  framesSinceChange++;
+
+  if(!isEnabled())
+  {
+    level = OFX_WEBCAM_QUALITY_FULL;
+    return;
+  }
+
+  //Wait for the previous change to show up in the average before acting again.
+  if(framesSinceChange < DEFAULT_GOVERNOR_SETTLE_FRAMES)
+  {
+    return;
+  }
+
+  if(smoothedTime > target && level < OFX_WEBCAM_QUALITY_SKIP_FRAMES)
+  {
+    level++;
+    framesSinceChange = 0;
+    ofLogNotice("ofxWebcamGovernor") << "Frame time " << smoothedTime << "ms over " << target << "ms, degrading to " << getLevelName();
+  }
+  else if(smoothedTime < target * recoverRatio && level > OFX_WEBCAM_QUALITY_FULL)
+  {
+    level--;
+    framesSinceChange = 0;
+    ofLogNotice("ofxWebcamGovernor") << "Frame time " << smoothedTime << "ms under budget, restoring " << getLevelName();
+  }
+}
+
+void ofxWebcamGovernor::reset()
+{
+  level = OFX_WEBCAM_QUALITY_FULL;
+  smoothedTime = 0;
+  lastTime = 0;
+  framesSinceChange = 0;
+}
+
+void ofxWebcamGovernor::setTarget(float millis)
+{
+  target = millis > 0 ? millis : 0;
+  reset();
+}
+
+void ofxWebcamGovernor::setSmoothing(float value)
+{
+  smoothing = ofClamp(value, 0, 0.99);
+}
+
+void ofxWebcamGovernor::setRecoverRatio(float value)
+{
+  recoverRatio = ofClamp(value, 0.1, 0.95);
+}
+
+float ofxWebcamGovernor::getTarget()
+{
+  return target;
+}
+
+float ofxWebcamGovernor::getSmoothedTime()
+{
+  return smoothedTime;
+}
+
+float ofxWebcamGovernor::getLastTime()
+{
+  return lastTime;
+}
+
+bool ofxWebcamGovernor::isEnabled()
+{
+  return target > 0;
+}
+
+int ofxWebcamGovernor::getLevel()
+{
+  return level;
+}
+
+string ofxWebcamGovernor::getLevelName()
+{
+  switch(level)
+  {
+    case OFX_WEBCAM_QUALITY_FULL: return "full";
+    case OFX_WEBCAM_QUALITY_NO_BLUR: return "no blur";
+    case OFX_WEBCAM_QUALITY_HALF_SCALE: return "half scale";
+    case OFX_WEBCAM_QUALITY_FEW_CANDIDATES: return "few candidates";
+    case OFX_WEBCAM_QUALITY_SKIP_FRAMES: return "skip frames";
+  }
+  return "unknown";
+}
+
+bool ofxWebcamGovernor::shouldBlur()
+{
+  return level < OFX_WEBCAM_QUALITY_NO_BLUR;
+}
+
+float ofxWebcamGovernor::getProcessingScale()
+{
+  return level >= OFX_WEBCAM_QUALITY_HALF_SCALE ? 0.5 : 1.0;
+}
+
+int ofxWebcamGovernor::getMaxCandidates(int requested)
+{
+  if(level >= OFX_WEBCAM_QUALITY_FEW_CANDIDATES)
+  {
+    return MAX(1, requested / 2);
+  }
+  return requested;
+}
+
+bool ofxWebcamGovernor::shouldSegment(int frameNumber)
+{
+  return level < OFX_WEBCAM_QUALITY_SKIP_FRAMES || frameNumber % 2 == 0;
+}
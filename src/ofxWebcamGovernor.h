@@ -0,0 +1,48 @@
+#pragma once
+#include "ofMain.h"
+
+#define DEFAULT_GOVERNOR_SETTLE_FRAMES 15
+
+enum ofxWebcamQualityLevel {
+  OFX_WEBCAM_QUALITY_FULL = 0,         //Everything enabled
+  OFX_WEBCAM_QUALITY_NO_BLUR,          //Blur is skipped
+  OFX_WEBCAM_QUALITY_HALF_SCALE,       //Segmentation runs at half resolution
+  OFX_WEBCAM_QUALITY_FEW_CANDIDATES,   //Fewer contours are considered for matching
+  OFX_WEBCAM_QUALITY_SKIP_FRAMES       //Segmentation runs every other frame, blobs are extrapolated in between
+};
+
+//Watches how long each tracker frame takes and moves between quality levels
+//to keep it under a latency target. Levels are cumulative: a higher level
+//keeps every degradation of the lower ones.
+class ofxWebcamGovernor {
+  private:
+    float target;
+    float smoothedTime;
+    float lastTime;
+    float smoothing;
+    float recoverRatio;
+    int level;
+    int framesSinceChange;
+
+  public:
+    ofxWebcamGovernor();
+    ~ofxWebcamGovernor();
+
+    void update(float frameMillis);
+    void reset();
+
+    void setTarget(float millis);
+    void setSmoothing(float value);
+    void setRecoverRatio(float value);
+    float getTarget();
+    float getSmoothedTime();
+    float getLastTime();
+    bool isEnabled();
+
+    int getLevel();
+    string getLevelName();
+    bool shouldBlur();
+    float getProcessingScale();
+    int getMaxCandidates(int requested);
+    bool shouldSegment(int frameNumber);
+};
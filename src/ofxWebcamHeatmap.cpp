@@ -0,0 +1,207 @@
+#include "ofxWebcamHeatmap.h"
+
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#endif
+
+ofxWebcamHeatmap::ofxWebcamHeatmap() : imageWidth(0), imageHeight(0), cellSize(DEFAULT_HEATMAP_CELL_SIZE), cols(0), rows(0), decay(DEFAULT_HEATMAP_DECAY) {
+
+}
+
+ofxWebcamHeatmap::~ofxWebcamHeatmap(){
+
+}
+
+void ofxWebcamHeatmap::setup(int width, int height, int cellSize)
+{
+  imageWidth = width;
+  imageHeight = height;
+  this->cellSize = MAX(1, cellSize);
+  cols = (width + this->cellSize - 1) / this->cellSize;
+  rows = (height + this->cellSize - 1) / this->cellSize;
+  grid.assign(cols * rows, 0);
+  occupancy.assign(cols * rows, 0);
+  floatPixels.allocate(cols, rows, OF_PIXELS_GRAY);
+}
+
+void ofxWebcamHeatmap::reset()
+{
+  std::fill(grid.begin(), grid.end(), 0);
+}
+
+bool ofxWebcamHeatmap::isAllocated()
+{
+  return !grid.empty();
+}
+
+void ofxWebcamHeatmap::setDecay(float perSecond)
+{
+  decay = ofClamp(perSecond, 0, 1);
+}
+
+float ofxWebcamHeatmap::getDecay()
+{
+  return decay;
+}
+
+int ofxWebcamHeatmap::getCellSize()
+{
+  return cellSize;
+}
+
+int ofxWebcamHeatmap::getCols()
+{
+  return cols;
+}
+
+int ofxWebcamHeatmap::getRows()
+{
+  return rows;
+}
+
+//grid = grid * retain + occupancy * dt, four cells at a time.
+void ofxWebcamHeatmap::accumulate(float dt)
+{
+  float retain = pow(1.0f - decay, dt);
+  int n = grid.size();
+  float * g = &grid[0];
+  const float * o = &occupancy[0];
+  int i = 0;
+
+#if defined(__SSE__)
+  const __m128 r = _mm_set1_ps(retain);
+  const __m128 t = _mm_set1_ps(dt);
+  for(; i + 4 <= n; i += 4)
+  {
+    __m128 v = _mm_mul_ps(_mm_loadu_ps(g + i), r);
+    v = _mm_add_ps(v, _mm_mul_ps(_mm_loadu_ps(o + i), t));
+    _mm_storeu_ps(g + i, v);
+  }
+#endif
+
+  for(; i < n; i++)
+  {
+    g[i] = g[i] * retain + o[i] * dt;
+  }
+}
+
+//Occupancy straight from the packed foreground mask, counted with popcount.
+void ofxWebcamHeatmap::addMask(ofxWebcamBinaryMask & mask, float dt)
+{
+  if(!isAllocated() || mask.getWidth() != imageWidth || mask.getHeight() != imageHeight) return;
+
+  std::fill(occupancy.begin(), occupancy.end(), 0);
+  for(int y=0; y<imageHeight; y++)
+  {
+    float * cells = &occupancy[(y / cellSize) * cols];
+    for(int c=0; c<cols; c++)
+    {
+      int start = c * cellSize;
+      int end = MIN(imageWidth, start + cellSize);
+      cells[c] += mask.count(y, start, end);
+    }
+  }
+
+  float area = 1.0f / (cellSize * cellSize);
+  for(size_t i=0; i<occupancy.size(); i++) occupancy[i] *= area;
+
+  accumulate(dt);
+}
+
+//Occupancy from an 8 bit mask where any non zero pixel is foreground.
+void ofxWebcamHeatmap::addPixels(const ofPixels & pix, float dt)
+{
+  if(!isAllocated() || (int)pix.getWidth() != imageWidth || (int)pix.getHeight() != imageHeight) return;
+
+  std::fill(occupancy.begin(), occupancy.end(), 0);
+  const unsigned char * data = pix.getData();
+  int channels = pix.getNumChannels();
+  for(int y=0; y<imageHeight; y++)
+  {
+    const unsigned char * line = data + (size_t)y * imageWidth * channels;
+    float * cells = &occupancy[(y / cellSize) * cols];
+    for(int x=0; x<imageWidth; x++)
+    {
+      if(line[x * channels] != 0) cells[x / cellSize] += 1;
+    }
+  }
+
+  float area = 1.0f / (cellSize * cellSize);
+  for(size_t i=0; i<occupancy.size(); i++) occupancy[i] *= area;
+
+  accumulate(dt);
+}
+
+//Occupancy from the bounding boxes of the active blobs, weighted by how
+//much of each cell the box covers.
+void ofxWebcamHeatmap::addBlobs(vector<ofxWebcamBlob> & blobs, float dt)
+{
+  if(!isAllocated()) return;
+
+  std::fill(occupancy.begin(), occupancy.end(), 0);
+  for(size_t b=0; b<blobs.size(); b++)
+  {
+    if(!blobs[b].isActive()) continue;
+
+    const ofRectangle & r = blobs[b].blob.boundingRect;
+    int c0 = MAX(0, (int)(r.x / cellSize));
+    int c1 = MIN(cols - 1, (int)((r.x + r.width) / cellSize));
+    int r0 = MAX(0, (int)(r.y / cellSize));
+    int r1 = MIN(rows - 1, (int)((r.y + r.height) / cellSize));
+
+    for(int cy=r0; cy<=r1; cy++)
+    {
+      float overlapY = MIN(r.y + r.height, (cy + 1) * cellSize) - MAX(r.y, cy * cellSize);
+      for(int cx=c0; cx<=c1; cx++)
+      {
+        float overlapX = MIN(r.x + r.width, (cx + 1) * cellSize) - MAX(r.x, cx * cellSize);
+        if(overlapX > 0 && overlapY > 0)
+        {
+          float & cell = occupancy[cy * cols + cx];
+          cell = MIN(1.0f, cell + overlapX * overlapY / (cellSize * cellSize));
+        }
+      }
+    }
+  }
+
+  accumulate(dt);
+}
+
+const float * ofxWebcamHeatmap::getData()
+{
+  return grid.empty() ? NULL : &grid[0];
+}
+
+float ofxWebcamHeatmap::getMax()
+{
+  float m = 0;
+  for(size_t i=0; i<grid.size(); i++) m = MAX(m, grid[i]);
+  return m;
+}
+
+ofFloatPixels & ofxWebcamHeatmap::getFloatPixels()
+{
+  if(isAllocated())
+  {
+    std::copy(grid.begin(), grid.end(), floatPixels.getData());
+  }
+  return floatPixels;
+}
+
+//8 bit image of the grid, one pixel per cell. maxValue maps to 255; 0 means
+//normalise to the current maximum.
+void ofxWebcamHeatmap::getPixels(ofPixels & pix, float maxValue)
+{
+  if((int)pix.getWidth() != cols || (int)pix.getHeight() != rows || pix.getNumChannels() != 1)
+  {
+    pix.allocate(cols, rows, OF_PIXELS_GRAY);
+  }
+
+  float top = maxValue > 0 ? maxValue : getMax();
+  float scale = top > 0 ? 255.0f / top : 0;
+  unsigned char * dst = pix.getData();
+  for(size_t i=0; i<grid.size(); i++)
+  {
+    dst[i] = (unsigned char)MIN(255.0f, grid[i] * scale);
+  }
+}
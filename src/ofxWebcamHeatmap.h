@@ -0,0 +1,48 @@
+#pragma once
+#include "ofMain.h"
+#include "ofxWebcamBinaryMask.h"
+#include "ofxWebcamBlob.h"
+
+#define DEFAULT_HEATMAP_CELL_SIZE 8
+#define DEFAULT_HEATMAP_DECAY 0.05
+
+//A coarse occupancy grid over the tracked image. Each cell accumulates how
+//long it was occupied (seconds, weighted by the covered fraction) and loses
+//a fraction decay of its value every second.
+class ofxWebcamHeatmap {
+  private:
+    int imageWidth;
+    int imageHeight;
+    int cellSize;
+    int cols;
+    int rows;
+    float decay;
+    vector<float> grid;
+    vector<float> occupancy;
+    ofFloatPixels floatPixels;
+
+    void accumulate(float dt);
+
+  public:
+    ofxWebcamHeatmap();
+    ~ofxWebcamHeatmap();
+
+    void setup(int width, int height, int cellSize=DEFAULT_HEATMAP_CELL_SIZE);
+    void reset();
+    bool isAllocated();
+
+    void setDecay(float perSecond);
+    float getDecay();
+    int getCellSize();
+    int getCols();
+    int getRows();
+
+    void addMask(ofxWebcamBinaryMask & mask, float dt);
+    void addPixels(const ofPixels & pix, float dt);
+    void addBlobs(vector<ofxWebcamBlob> & blobs, float dt);
+
+    const float * getData();
+    float getMax();
+    ofFloatPixels & getFloatPixels();
+    void getPixels(ofPixels & pix, float maxValue=0);
+};
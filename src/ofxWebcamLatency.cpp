@@ -0,0 +1,84 @@
+#include "ofxWebcamLatency.h"
+
+ofxWebcamLatencyHistogram::ofxWebcamLatencyHistogram(){
+  setup();
+}
+
+ofxWebcamLatencyHistogram::~ofxWebcamLatencyHistogram(){
+
+}
+
+void ofxWebcamLatencyHistogram::setup(int numBuckets, float bucketMillis)
+{
+  buckets.assign(MAX(1, numBuckets), 0);
+  bucketSize = MAX(0.001f, bucketMillis);
+  reset();
+}
+
+void ofxWebcamLatencyHistogram::add(float millis)
+{
+  millis = MAX(0, millis);
+  int index = MIN((int)buckets.size() - 1, (int)(millis / bucketSize));
+  buckets[index]++;
+  count++;
+  sum += millis;
+  maxValue = MAX(maxValue, millis);
+  lastValue = millis;
+}
+
+void ofxWebcamLatencyHistogram::reset()
+{
+  std::fill(buckets.begin(), buckets.end(), 0);
+  count = 0;
+  sum = 0;
+  maxValue = 0;
+  lastValue = 0;
+}
+
+uint64_t ofxWebcamLatencyHistogram::getCount()
+{
+  return count;
+}
+
+float ofxWebcamLatencyHistogram::getLast()
+{
+  return lastValue;
+}
+
+float ofxWebcamLatencyHistogram::getMean()
+{
+  return count > 0 ? sum / count : 0;
+}
+
+float ofxWebcamLatencyHistogram::getMax()
+{
+  return maxValue;
+}
+
+//p between 0 and 1, read as the upper edge of the bucket it falls in.
+float ofxWebcamLatencyHistogram::getPercentile(float p)
+{
+  if(count == 0) return 0;
+
+  uint64_t target = (uint64_t)ceil(ofClamp(p, 0, 1) * count);
+  uint64_t seen = 0;
+  for(size_t i=0; i<buckets.size(); i++)
+  {
+    seen += buckets[i];
+    if(seen >= target && seen > 0)
+    {
+      return MIN(maxValue, (i + 1) * bucketSize);
+    }
+  }
+  return maxValue;
+}
+
+float ofxWebcamLatencyHistogram::getBucketSize()
+{
+  return bucketSize;
+}
+
+vector<uint32_t> & ofxWebcamLatencyHistogram::getBuckets()
+{
+  return buckets;
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include "ofMain.h"
+
+#define DEFAULT_LATENCY_BUCKETS 200
+#define DEFAULT_LATENCY_BUCKET_MS 1.0
+
+//Histogram of latencies in milliseconds. Values past the last bucket are
+//counted in it, so percentiles there read as "at least".
+class ofxWebcamLatencyHistogram {
+  private:
+    vector<uint32_t> buckets;
+    float bucketSize;
+    uint64_t count;
+    double sum;
+    float maxValue;
+    float lastValue;
+
+  public:
+    ofxWebcamLatencyHistogram();
+    ~ofxWebcamLatencyHistogram();
+
+    void setup(int numBuckets=DEFAULT_LATENCY_BUCKETS, float bucketMillis=DEFAULT_LATENCY_BUCKET_MS);
+    void add(float millis);
+    void reset();
+
+    uint64_t getCount();
+    float getLast();
+    float getMean();
+    float getMax();
+    float getPercentile(float p);
+    float getBucketSize();
+    vector<uint32_t> & getBuckets();
+};
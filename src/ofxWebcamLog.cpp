@@ -0,0 +1,575 @@
+#include "ofxWebcamLog.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#define LOG_VERSION 1
+#define LOG_HEADER_SIZE 8
+#define LOG_KEYFRAME 1
+#define LOG_BLOB_WHOLE 1
+#define LOG_BLOB_OVERLAPPING 2
+
+//Header of the sidecar index, followed by the frame and id entries.
+struct ofxWebcamLogIndexHeader {
+  char magic[4];
+  uint32_t version;
+  uint64_t logSize;
+  uint64_t numFrames;
+  uint64_t numIds;
+};
+
+static inline void putVarint(vector<uint8_t> & out, uint64_t v)
+{
+  while(v >= 0x80)
+  {
+    out.push_back((uint8_t)(v | 0x80));
+    v >>= 7;
+  }
+  out.push_back((uint8_t)v);
+}
+
+static inline void putSigned(vector<uint8_t> & out, int64_t v)
+{
+  putVarint(out, ((uint64_t)v << 1) ^ (uint64_t)(v >> 63));
+}
+
+static inline bool getVarint(const uint8_t * data, size_t size, size_t & offset, uint64_t & v)
+{
+  v = 0;
+  for(int shift=0; shift<64; shift+=7)
+  {
+    if(offset >= size) return false;
+    uint8_t b = data[offset++];
+    v |= (uint64_t)(b & 0x7f) << shift;
+    if(!(b & 0x80)) return true;
+  }
+  return false;
+}
+
+static inline bool getSigned(const uint8_t * data, size_t size, size_t & offset, int64_t & v)
+{
+  uint64_t u;
+  if(!getVarint(data, size, offset, u)) return false;
+  v = (int64_t)(u >> 1) ^ -(int64_t)(u & 1);
+  return true;
+}
+
+static bool byId(const ofxWebcamLogState & a, const ofxWebcamLogState & b)
+{
+  return a.id < b.id;
+}
+
+ofxWebcamLogWriter::ofxWebcamLogWriter() : file(NULL), keyframeInterval(DEFAULT_LOG_KEYFRAME_INTERVAL), offset(0), lastFrame(0), lastTime(0) {
+
+}
+
+ofxWebcamLogWriter::~ofxWebcamLogWriter(){
+  close();
+}
+
+//Starts a new log at path, replacing any log and index already there.
+bool ofxWebcamLogWriter::open(string path, int keyframeInterval)
+{
+  close();
+  this->path = path;
+  this->keyframeInterval = MAX(1, keyframeInterval);
+  ofFile::removeFile(path + ".idx", false);
+
+  file = fopen(path.c_str(), "wb");
+  if(file == NULL)
+  {
+    ofLogError("ofxWebcamLogWriter::open") << "Could not open " << path;
+    return false;
+  }
+
+  const char header[LOG_HEADER_SIZE] = {'O', 'W', 'T', 'L', LOG_VERSION, 0, 0, 0};
+  fwrite(header, 1, LOG_HEADER_SIZE, file);
+  offset = LOG_HEADER_SIZE;
+  frames.clear();
+  ids.clear();
+  previous.clear();
+  return true;
+}
+
+bool ofxWebcamLogWriter::isOpen()
+{
+  return file != NULL;
+}
+
+string ofxWebcamLogWriter::getPath()
+{
+  return path;
+}
+
+//Logs the active blobs. timeMicros is the capture time of the frame.
+void ofxWebcamLogWriter::addFrame(uint64_t frameNumber, uint64_t timeMicros, vector<ofxWebcamBlob> & blobs)
+{
+  if(file == NULL) return;
+
+  current.clear();
+  for(size_t i=0; i<blobs.size(); i++)
+  {
+    if(!blobs[i].isActive()) continue;
+    const ofxCvBlob & b = blobs[i].blob;
+    ofxWebcamLogState s;
+    s.id = blobs[i].id;
+    s.x = (int32_t)roundf(b.centroid.x * 4);
+    s.y = (int32_t)roundf(b.centroid.y * 4);
+    s.width = (int32_t)roundf(b.boundingRect.width * 4);
+    s.height = (int32_t)roundf(b.boundingRect.height * 4);
+    s.area = (int32_t)roundf(b.area);
+    s.overlapping = blobs[i].isOverlapping();
+    current.push_back(s);
+  }
+  std::sort(current.begin(), current.end(), byId);
+
+  bool keyframe = frames.size() % keyframeInterval == 0;
+  record.clear();
+  putVarint(record, keyframe ? LOG_KEYFRAME : 0);
+  if(keyframe)
+  {
+    putVarint(record, frameNumber);
+    putVarint(record, timeMicros);
+  }
+  else
+  {
+    putVarint(record, frameNumber - lastFrame);
+    putSigned(record, (int64_t)(timeMicros - lastTime));
+  }
+  putVarint(record, current.size());
+
+  int lastId = -1;
+  size_t j = 0;
+  for(size_t i=0; i<current.size(); i++)
+  {
+    const ofxWebcamLogState & s = current[i];
+    while(j < previous.size() && previous[j].id < s.id) j++;
+    const ofxWebcamLogState * p = (!keyframe && j < previous.size() && previous[j].id == s.id) ? &previous[j] : NULL;
+
+    putVarint(record, s.id - lastId - 1);
+    putVarint(record, (p ? 0 : LOG_BLOB_WHOLE) | (s.overlapping ? LOG_BLOB_OVERLAPPING : 0));
+    putSigned(record, s.x - (p ? p->x : 0));
+    putSigned(record, s.y - (p ? p->y : 0));
+    putSigned(record, s.width - (p ? p->width : 0));
+    putSigned(record, s.height - (p ? p->height : 0));
+    putSigned(record, s.area - (p ? p->area : 0));
+    lastId = s.id;
+
+    std::map<int, ofxWebcamLogIdEntry>::iterator it = ids.find(s.id);
+    if(it == ids.end())
+    {
+      ofxWebcamLogIdEntry entry = {s.id, frames.size(), frames.size()};
+      ids[s.id] = entry;
+    }
+    else
+    {
+      it->second.last = frames.size();
+    }
+  }
+
+  ofxWebcamLogFrameEntry entry;
+  entry.offset = offset;
+  entry.frame = frameNumber;
+  entry.time = timeMicros;
+  entry.keyframe = keyframe ? frames.size() : frames.back().keyframe;
+  frames.push_back(entry);
+
+  fwrite(&record[0], 1, record.size(), file);
+  offset += record.size();
+  lastFrame = frameNumber;
+  lastTime = timeMicros;
+  previous.swap(current);
+}
+
+uint64_t ofxWebcamLogWriter::getNumFrames()
+{
+  return frames.size();
+}
+
+//Bytes written to the log so far.
+uint64_t ofxWebcamLogWriter::getSize()
+{
+  return offset;
+}
+
+void ofxWebcamLogWriter::writeIndex()
+{
+  string indexPath = path + ".idx";
+  FILE * index = fopen(indexPath.c_str(), "wb");
+  if(index == NULL)
+  {
+    ofLogError("ofxWebcamLogWriter::close") << "Could not write " << indexPath;
+    return;
+  }
+
+  ofxWebcamLogIndexHeader header = {{'O', 'W', 'T', 'I'}, LOG_VERSION, offset, frames.size(), ids.size()};
+  fwrite(&header, sizeof(header), 1, index);
+  if(!frames.empty())
+  {
+    fwrite(&frames[0], sizeof(ofxWebcamLogFrameEntry), frames.size(), index);
+  }
+  for(std::map<int, ofxWebcamLogIdEntry>::iterator it=ids.begin(); it!=ids.end(); ++it)
+  {
+    fwrite(&it->second, sizeof(ofxWebcamLogIdEntry), 1, index);
+  }
+  fclose(index);
+}
+
+void ofxWebcamLogWriter::close()
+{
+  if(file == NULL) return;
+  fclose(file);
+  file = NULL;
+  writeIndex();
+}
+
+ofxWebcamLogReader::ofxWebcamLogReader() : data(NULL), size(0), decodedIndex(SIZE_MAX) {
+
+}
+
+ofxWebcamLogReader::~ofxWebcamLogReader(){
+  close();
+}
+
+bool ofxWebcamLogReader::open(string path)
+{
+  close();
+  if(!map(path)) return false;
+
+  if(size < LOG_HEADER_SIZE || memcmp(data, "OWTL", 4) != 0 || data[4] != LOG_VERSION)
+  {
+    ofLogError("ofxWebcamLogReader::open") << path << " is not a tracking log";
+    close();
+    return false;
+  }
+
+  if(!loadIndex(path + ".idx"))
+  {
+    ofLogNotice("ofxWebcamLogReader::open") << "Indexing " << path;
+    buildIndex();
+  }
+  return true;
+}
+
+bool ofxWebcamLogReader::map(string path)
+{
+#ifdef _WIN32
+  std::ifstream in(path.c_str(), std::ios::binary | std::ios::ate);
+  if(!in)
+  {
+    ofLogError("ofxWebcamLogReader::open") << "Could not open " << path;
+    return false;
+  }
+  fallback.resize((size_t)in.tellg());
+  in.seekg(0);
+  if(!fallback.empty())
+  {
+    in.read((char *)&fallback[0], fallback.size());
+  }
+  data = fallback.empty() ? NULL : &fallback[0];
+  size = fallback.size();
+  return true;
+#else
+  int descriptor = ::open(path.c_str(), O_RDONLY);
+  if(descriptor < 0)
+  {
+    ofLogError("ofxWebcamLogReader::open") << "Could not open " << path;
+    return false;
+  }
+
+  struct stat info;
+  if(fstat(descriptor, &info) != 0 || info.st_size == 0)
+  {
+    ::close(descriptor);
+    return info.st_size == 0;
+  }
+
+  void * mapped = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+  ::close(descriptor);
+  if(mapped == MAP_FAILED)
+  {
+    ofLogError("ofxWebcamLogReader::open") << "Could not map " << path;
+    return false;
+  }
+  data = (const uint8_t *)mapped;
+  size = info.st_size;
+  return true;
+#endif
+}
+
+bool ofxWebcamLogReader::loadIndex(string path)
+{
+  FILE * index = fopen(path.c_str(), "rb");
+  if(index == NULL) return false;
+
+  ofxWebcamLogIndexHeader header;
+  bool valid = fread(&header, sizeof(header), 1, index) == 1
+    && memcmp(header.magic, "OWTI", 4) == 0
+    && header.version == LOG_VERSION
+    && header.logSize == size;
+
+  if(valid)
+  {
+    frames.resize(header.numFrames);
+    ids.resize(header.numIds);
+    valid = (frames.empty() || fread(&frames[0], sizeof(ofxWebcamLogFrameEntry), frames.size(), index) == frames.size())
+      && (ids.empty() || fread(&ids[0], sizeof(ofxWebcamLogIdEntry), ids.size(), index) == ids.size());
+  }
+  fclose(index);
+
+  if(!valid)
+  {
+    frames.clear();
+    ids.clear();
+  }
+  return valid;
+}
+
+//Decodes every record to find the frames and ids. A record cut short at the
+//end, from a log that was still being written, is left out.
+bool ofxWebcamLogReader::buildIndex()
+{
+  frames.clear();
+  ids.clear();
+  std::map<int, ofxWebcamLogIdEntry> seen;
+
+  size_t offset = LOG_HEADER_SIZE;
+  uint64_t frame = 0;
+  uint64_t time = 0;
+  bool keyframe;
+  while(offset < size)
+  {
+    ofxWebcamLogFrameEntry entry;
+    entry.offset = offset;
+    if(!decode(offset, frame, time, keyframe)) break;
+    if(!keyframe && frames.empty()) break;
+
+    entry.frame = frame;
+    entry.time = time;
+    entry.keyframe = keyframe ? frames.size() : frames.back().keyframe;
+
+    for(size_t i=0; i<state.size(); i++)
+    {
+      std::map<int, ofxWebcamLogIdEntry>::iterator it = seen.find(state[i].id);
+      if(it == seen.end())
+      {
+        ofxWebcamLogIdEntry id = {state[i].id, frames.size(), frames.size()};
+        seen[state[i].id] = id;
+      }
+      else
+      {
+        it->second.last = frames.size();
+      }
+    }
+    frames.push_back(entry);
+  }
+
+  for(std::map<int, ofxWebcamLogIdEntry>::iterator it=seen.begin(); it!=seen.end(); ++it)
+  {
+    ids.push_back(it->second);
+  }
+  decodedIndex = SIZE_MAX;
+  return !frames.empty();
+}
+
+//Reads the record at offset on top of the previous frame in state. frame
+//and time hold the previous frame's values and are updated.
+bool ofxWebcamLogReader::decode(size_t & offset, uint64_t & frame, uint64_t & time, bool & keyframe)
+{
+  uint64_t flags, f, count;
+  int64_t t;
+  if(!getVarint(data, size, offset, flags)) return false;
+  keyframe = flags & LOG_KEYFRAME;
+  if(keyframe)
+  {
+    uint64_t absolute;
+    if(!getVarint(data, size, offset, f) || !getVarint(data, size, offset, absolute)) return false;
+    frame = f;
+    time = absolute;
+  }
+  else
+  {
+    if(!getVarint(data, size, offset, f) || !getSigned(data, size, offset, t)) return false;
+    frame += f;
+    time += t;
+  }
+  if(!getVarint(data, size, offset, count)) return false;
+
+  decoded.clear();
+  int lastId = -1;
+  size_t j = 0;
+  for(uint64_t i=0; i<count; i++)
+  {
+    uint64_t gap, blobFlags;
+    int64_t v[5];
+    if(!getVarint(data, size, offset, gap) || !getVarint(data, size, offset, blobFlags)) return false;
+    for(int k=0; k<5; k++)
+    {
+      if(!getSigned(data, size, offset, v[k])) return false;
+    }
+
+    ofxWebcamLogState s;
+    s.id = lastId + 1 + (int)gap;
+    s.overlapping = blobFlags & LOG_BLOB_OVERLAPPING;
+    lastId = s.id;
+
+    while(j < state.size() && state[j].id < s.id) j++;
+    const ofxWebcamLogState * p = (!(blobFlags & LOG_BLOB_WHOLE) && j < state.size() && state[j].id == s.id) ? &state[j] : NULL;
+    s.x = (int32_t)v[0] + (p ? p->x : 0);
+    s.y = (int32_t)v[1] + (p ? p->y : 0);
+    s.width = (int32_t)v[2] + (p ? p->width : 0);
+    s.height = (int32_t)v[3] + (p ? p->height : 0);
+    s.area = (int32_t)v[4] + (p ? p->area : 0);
+    decoded.push_back(s);
+  }
+  state.swap(decoded);
+  return true;
+}
+
+bool ofxWebcamLogReader::isOpen()
+{
+  return data != NULL;
+}
+
+void ofxWebcamLogReader::close()
+{
+#ifndef _WIN32
+  if(data != NULL)
+  {
+    munmap((void *)data, size);
+  }
+#endif
+  data = NULL;
+  size = 0;
+  fallback.clear();
+  frames.clear();
+  ids.clear();
+  state.clear();
+  decodedIndex = SIZE_MAX;
+}
+
+size_t ofxWebcamLogReader::getNumFrames()
+{
+  return frames.size();
+}
+
+//The tracker frame number of a logged frame.
+uint64_t ofxWebcamLogReader::getFrameNumber(size_t index)
+{
+  return index < frames.size() ? frames[index].frame : 0;
+}
+
+//Capture time of a logged frame in microseconds.
+uint64_t ofxWebcamLogReader::getTime(size_t index)
+{
+  return index < frames.size() ? frames[index].time : 0;
+}
+
+uint64_t ofxWebcamLogReader::getStartTime()
+{
+  return frames.empty() ? 0 : frames.front().time;
+}
+
+uint64_t ofxWebcamLogReader::getEndTime()
+{
+  return frames.empty() ? 0 : frames.back().time;
+}
+
+//Index of the first frame captured at or after timeMicros, or
+//getNumFrames() if there is none.
+size_t ofxWebcamLogReader::seek(uint64_t timeMicros)
+{
+  size_t low = 0;
+  size_t high = frames.size();
+  while(low < high)
+  {
+    size_t mid = (low + high) / 2;
+    if(frames[mid].time < timeMicros) low = mid + 1;
+    else high = mid;
+  }
+  return low;
+}
+
+//Reading frames in order decodes each record once; jumping anywhere else
+//decodes from the keyframe before it.
+bool ofxWebcamLogReader::readFrame(size_t index, vector<ofxWebcamLogBlob> & blobs)
+{
+  blobs.clear();
+  if(index >= frames.size()) return false;
+
+  size_t start = (decodedIndex != SIZE_MAX && index == decodedIndex + 1) ? index : frames[index].keyframe;
+  for(size_t i=start; i<=index; i++)
+  {
+    size_t offset = frames[i].offset;
+    uint64_t frame = i > 0 ? frames[i - 1].frame : 0;
+    uint64_t time = i > 0 ? frames[i - 1].time : 0;
+    bool keyframe;
+    if(!decode(offset, frame, time, keyframe))
+    {
+      decodedIndex = SIZE_MAX;
+      return false;
+    }
+  }
+  decodedIndex = index;
+
+  blobs.resize(state.size());
+  for(size_t i=0; i<state.size(); i++)
+  {
+    const ofxWebcamLogState & s = state[i];
+    ofxWebcamLogBlob & b = blobs[i];
+    b.id = s.id;
+    b.centroid = ofVec2f(s.x * 0.25f, s.y * 0.25f);
+    b.width = s.width * 0.25f;
+    b.height = s.height * 0.25f;
+    b.area = s.area;
+    b.overlapping = s.overlapping;
+  }
+  return true;
+}
+
+size_t ofxWebcamLogReader::getNumIds()
+{
+  return ids.size();
+}
+
+void ofxWebcamLogReader::getIds(vector<int> & out)
+{
+  out.resize(ids.size());
+  for(size_t i=0; i<ids.size(); i++)
+  {
+    out[i] = (int)ids[i].id;
+  }
+}
+
+//Every logged position of one blob, oldest first. Only the frames between
+//its first and last appearance are decoded.
+int ofxWebcamLogReader::getTrack(int id, vector<ofxWebcamLogSample> & samples)
+{
+  samples.clear();
+  size_t low = 0;
+  size_t high = ids.size();
+  while(low < high)
+  {
+    size_t mid = (low + high) / 2;
+    if(ids[mid].id < id) low = mid + 1;
+    else high = mid;
+  }
+  if(low == ids.size() || ids[low].id != id) return 0;
+
+  for(uint64_t f=ids[low].first; f<=ids[low].last; f++)
+  {
+    if(!readFrame(f, scratch)) break;
+    for(size_t i=0; i<scratch.size(); i++)
+    {
+      if(scratch[i].id != id) continue;
+      ofxWebcamLogSample sample = {frames[f].frame, frames[f].time, scratch[i]};
+      samples.push_back(sample);
+      break;
+    }
+  }
+  return samples.size();
+}
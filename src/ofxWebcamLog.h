@@ -0,0 +1,129 @@
+#pragma once
+#include "ofMain.h"
+#include "ofxWebcamBlob.h"
+
+#define DEFAULT_LOG_KEYFRAME_INTERVAL 30
+
+//One blob as stored in a tracking log. Positions and sizes are kept to a
+//quarter of a pixel.
+struct ofxWebcamLogBlob {
+  int id;
+  ofVec2f centroid;
+  float width;
+  float height;
+  float area;
+  bool overlapping;
+};
+
+//A blob at one moment of its track, as returned by ofxWebcamLogReader::getTrack().
+struct ofxWebcamLogSample {
+  uint64_t frame;
+  uint64_t time;
+  ofxWebcamLogBlob blob;
+};
+
+//Where a frame starts in the log. Entries are written to the sidecar index
+//(the log path with ".idx" appended) exactly as they are in memory.
+struct ofxWebcamLogFrameEntry {
+  uint64_t offset;
+  uint64_t frame;
+  uint64_t time; //microseconds
+  uint64_t keyframe; //entry of the keyframe this frame decodes from
+};
+
+//The frames a blob id appears in, first to last.
+struct ofxWebcamLogIdEntry {
+  int64_t id;
+  uint64_t first;
+  uint64_t last;
+};
+
+//Shared by the writer and reader: the previous frame's blobs, sorted by id,
+//with everything in quarter pixels so deltas are exact.
+struct ofxWebcamLogState {
+  int id;
+  int32_t x;
+  int32_t y;
+  int32_t width;
+  int32_t height;
+  int32_t area;
+  bool overlapping;
+};
+
+//Appends the active blobs of every frame to a compact binary log. Each
+//frame is a record of varints: frame number and time as deltas from the
+//previous frame, ids as gaps in ascending order and coordinates as zigzag
+//deltas from the same blob in the previous frame. Every keyframeInterval
+//frames everything is stored whole, so a reader can start there.
+//The sidecar index is written on close; a log without one is still readable.
+class ofxWebcamLogWriter {
+  private:
+    FILE * file;
+    string path;
+    int keyframeInterval;
+    uint64_t offset;
+    uint64_t lastFrame;
+    uint64_t lastTime;
+    vector<uint8_t> record;
+    vector<ofxWebcamLogState> previous;
+    vector<ofxWebcamLogState> current;
+    vector<ofxWebcamLogFrameEntry> frames;
+    std::map<int, ofxWebcamLogIdEntry> ids;
+
+    void writeIndex();
+
+  public:
+    ofxWebcamLogWriter();
+    ~ofxWebcamLogWriter();
+
+    bool open(string path, int keyframeInterval=DEFAULT_LOG_KEYFRAME_INTERVAL);
+    bool isOpen();
+    string getPath();
+    void addFrame(uint64_t frameNumber, uint64_t timeMicros, vector<ofxWebcamBlob> & blobs);
+    uint64_t getNumFrames();
+    uint64_t getSize();
+    void close();
+};
+
+//Reads a tracking log through a memory map. The sidecar index gives every
+//frame's offset and time and the frames each id was seen in, so seeking by
+//time is a binary search and a track is decoded from its first frame to
+//its last. If the index is missing or does not match the log, it is rebuilt
+//by scanning the log once.
+class ofxWebcamLogReader {
+  private:
+    const uint8_t * data;
+    size_t size;
+    vector<uint8_t> fallback; //Holds the whole log where there is no mmap
+    vector<ofxWebcamLogFrameEntry> frames;
+    vector<ofxWebcamLogIdEntry> ids;
+    vector<ofxWebcamLogState> state;
+    vector<ofxWebcamLogState> decoded;
+    vector<ofxWebcamLogBlob> scratch;
+    size_t decodedIndex;
+
+    bool map(string path);
+    bool loadIndex(string path);
+    bool buildIndex();
+    bool decode(size_t & offset, uint64_t & frame, uint64_t & time, bool & keyframe);
+
+  public:
+    ofxWebcamLogReader();
+    ~ofxWebcamLogReader();
+
+    bool open(string path);
+    bool isOpen();
+    void close();
+
+    size_t getNumFrames();
+    uint64_t getFrameNumber(size_t index);
+    uint64_t getTime(size_t index);
+    uint64_t getStartTime();
+    uint64_t getEndTime();
+    size_t seek(uint64_t timeMicros);
+    bool readFrame(size_t index, vector<ofxWebcamLogBlob> & blobs);
+
+    size_t getNumIds();
+    void getIds(vector<int> & out);
+    int getTrack(int id, vector<ofxWebcamLogSample> & samples);
+};
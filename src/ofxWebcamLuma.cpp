@@ -0,0 +1,199 @@
+#include "ofxWebcamLuma.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+bool ofxWebcamLuma::isSupported(ofPixelFormat format)
+{
+  switch(format)
+  {
+    case OF_PIXELS_GRAY:
+    case OF_PIXELS_Y:
+    case OF_PIXELS_RGB:
+    case OF_PIXELS_BGR:
+    case OF_PIXELS_RGBA:
+    case OF_PIXELS_YUY2:
+    case OF_PIXELS_UYVY:
+    case OF_PIXELS_NV12:
+    case OF_PIXELS_NV21:
+    case OF_PIXELS_I420:
+    case OF_PIXELS_YV12:
+      return true;
+    default:
+      return false;
+  }
+}
+
+//Picks every other byte starting at offset: the Y samples of packed 4:2:2.
+static void extractPacked(const unsigned char * in, unsigned char * out, size_t count, int offset)
+{
+  size_t i = 0;
+
+#if defined(__SSE2__)
+  const __m128i low = _mm_set1_epi16(0x00FF);
+  for(; i + 16 <= count; i += 16)
+  {
+    __m128i a = _mm_loadu_si128((const __m128i *)(in + i*2));
+    __m128i b = _mm_loadu_si128((const __m128i *)(in + i*2 + 16));
+    if(offset == 1)
+    {
+      a = _mm_srli_epi16(a, 8);
+      b = _mm_srli_epi16(b, 8);
+    }
+    else
+    {
+      a = _mm_and_si128(a, low);
+      b = _mm_and_si128(b, low);
+    }
+    _mm_storeu_si128((__m128i *)(out + i), _mm_packus_epi16(a, b));
+  }
+#endif
+
+  for(; i < count; i++)
+  {
+    out[i] = in[i*2 + offset];
+  }
+}
+
+void ofxWebcamLuma::extract(const ofPixels & src, ofPixels & luma)
+{
+  int w = src.getWidth();
+  int h = src.getHeight();
+  if((int)luma.getWidth() != w || (int)luma.getHeight() != h || luma.getNumChannels() != 1)
+  {
+    luma.allocate(w, h, OF_PIXELS_GRAY);
+  }
+
+  const unsigned char * in = src.getData();
+  unsigned char * out = luma.getData();
+  size_t count = (size_t)w * h;
+
+  switch(src.getPixelFormat())
+  {
+    //Planar formats start with a full resolution Y plane.
+    case OF_PIXELS_GRAY:
+    case OF_PIXELS_Y:
+    case OF_PIXELS_NV12:
+    case OF_PIXELS_NV21:
+    case OF_PIXELS_I420:
+    case OF_PIXELS_YV12:
+      memcpy(out, in, count);
+      break;
+
+    case OF_PIXELS_YUY2:
+      extractPacked(in, out, count, 0);
+      break;
+
+    case OF_PIXELS_UYVY:
+      extractPacked(in, out, count, 1);
+      break;
+
+    default:
+    {
+      //BT.601 weights in 14 bit fixed point with rounding, the same
+      //integer arithmetic as cvCvtColor, so results match it exactly.
+      //Scalar: SSE2 has no byte shuffle to split RGB triplets cheaply.
+      int channels = src.getNumChannels();
+      bool bgr = src.getPixelFormat() == OF_PIXELS_BGR;
+      for(size_t i=0; i<count; i++)
+      {
+        const unsigned char * p = in + i * channels;
+        int r = bgr ? p[2] : p[0];
+        int b = bgr ? p[0] : p[2];
+        out[i] = (4899 * r + 9617 * p[1] + 1868 * b + (1 << 13)) >> 14;
+      }
+      break;
+    }
+  }
+}
+
+static inline unsigned char clampByte(int v)
+{
+  return v < 0 ? 0 : (v > 255 ? 255 : v);
+}
+
+static inline void yuvToRgb(int y, int u, int v, unsigned char * rgb)
+{
+  int c = y - 16;
+  int d = u - 128;
+  int e = v - 128;
+  rgb[0] = clampByte((298 * c + 409 * e + 128) >> 8);
+  rgb[1] = clampByte((298 * c - 100 * d - 208 * e + 128) >> 8);
+  rgb[2] = clampByte((298 * c + 516 * d + 128) >> 8);
+}
+
+//Only used to show native frames in the debug views, so kept simple.
+void ofxWebcamLuma::toRgb(const ofPixels & src, ofPixels & rgb)
+{
+  int w = src.getWidth();
+  int h = src.getHeight();
+  if((int)rgb.getWidth() != w || (int)rgb.getHeight() != h || rgb.getNumChannels() != 3)
+  {
+    rgb.allocate(w, h, OF_PIXELS_RGB);
+  }
+
+  const unsigned char * in = src.getData();
+  unsigned char * out = rgb.getData();
+  ofPixelFormat format = src.getPixelFormat();
+
+  for(int y=0; y<h; y++)
+  {
+    for(int x=0; x<w; x++)
+    {
+      size_t i = (size_t)y * w + x;
+      unsigned char * o = out + i * 3;
+      int Y, U, V;
+
+      switch(format)
+      {
+        case OF_PIXELS_YUY2:
+          Y = in[i*2];
+          U = in[(i & ~(size_t)1)*2 + 1];
+          V = in[(i & ~(size_t)1)*2 + 3];
+          break;
+        case OF_PIXELS_UYVY:
+          Y = in[i*2 + 1];
+          U = in[(i & ~(size_t)1)*2];
+          V = in[(i & ~(size_t)1)*2 + 2];
+          break;
+        case OF_PIXELS_NV12:
+        case OF_PIXELS_NV21:
+        {
+          const unsigned char * uv = in + (size_t)w * h + (size_t)(y / 2) * w + (x & ~1);
+          Y = in[i];
+          U = format == OF_PIXELS_NV12 ? uv[0] : uv[1];
+          V = format == OF_PIXELS_NV12 ? uv[1] : uv[0];
+          break;
+        }
+        case OF_PIXELS_I420:
+        case OF_PIXELS_YV12:
+        {
+          size_t quarter = (size_t)(w / 2) * (h / 2);
+          size_t c = (size_t)(y / 2) * (w / 2) + x / 2;
+          const unsigned char * first = in + (size_t)w * h;
+          Y = in[i];
+          U = format == OF_PIXELS_I420 ? first[c] : first[quarter + c];
+          V = format == OF_PIXELS_I420 ? first[quarter + c] : first[c];
+          break;
+        }
+        case OF_PIXELS_GRAY:
+        case OF_PIXELS_Y:
+          o[0] = o[1] = o[2] = in[i];
+          continue;
+        default:
+        {
+          int channels = src.getNumChannels();
+          bool bgr = format == OF_PIXELS_BGR;
+          const unsigned char * p = in + i * channels;
+          o[0] = bgr ? p[2] : p[0];
+          o[1] = p[1];
+          o[2] = bgr ? p[0] : p[2];
+          continue;
+        }
+      }
+
+      yuvToRgb(Y, U, V, o);
+    }
+  }
+}
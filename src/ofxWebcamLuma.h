@@ -0,0 +1,12 @@
+#pragma once
+#include "ofMain.h"
+
+//Conversions between the formats cameras deliver and what the tracker needs.
+//Tracking only uses luma, so the Y plane is taken as is when the camera
+//provides one and only the debug views pay for a full RGB conversion.
+class ofxWebcamLuma {
+  public:
+    static bool isSupported(ofPixelFormat format);
+    static void extract(const ofPixels & src, ofPixels & luma);
+    static void toRgb(const ofPixels & src, ofPixels & rgb);
+};
@@ -0,0 +1,125 @@
+#include "ofxWebcamPreview.h"
+
+ofxWebcamPreview::ofxWebcamPreview()
+{
+  scale = DEFAULT_PREVIEW_SCALE;
+  rate = DEFAULT_PREVIEW_RATE;
+  lastUpdate = -1;
+#ifndef OFX_WEBCAM_TRACKER_HEADLESS
+  bufferSize[0] = 0;
+  bufferSize[1] = 0;
+  next = 0;
+  loaded = false;
+#endif
+}
+
+void ofxWebcamPreview::setScale(float value)
+{
+  scale = ofClamp(value, 0.05, 1.0);
+}
+
+//A rate of 0 refreshes on every draw.
+void ofxWebcamPreview::setRate(float fps)
+{
+  rate = MAX(0, fps);
+}
+
+float ofxWebcamPreview::getScale()
+{
+  return scale;
+}
+
+float ofxWebcamPreview::getRate()
+{
+  return rate;
+}
+
+bool ofxWebcamPreview::isDue(float now)
+{
+  return lastUpdate < 0 || rate <= 0 || now - lastUpdate >= 1.0 / rate;
+}
+
+//Nearest neighbour is plenty for looking at.
+void ofxWebcamPreview::update(const ofPixels & src, float now)
+{
+  lastUpdate = now;
+  int sw = src.getWidth();
+  int sh = src.getHeight();
+  int channels = src.getNumChannels();
+  int w = MAX(1, (int)(sw * scale));
+  int h = MAX(1, (int)(sh * scale));
+  if(sw == 0 || sh == 0) return;
+
+  if((int)pixels.getWidth() != w || (int)pixels.getHeight() != h || (int)pixels.getNumChannels() != channels)
+  {
+    pixels.allocate(w, h, channels == 1 ? OF_PIXELS_GRAY : OF_PIXELS_RGB);
+  }
+
+  const unsigned char * in = src.getData();
+  unsigned char * out = pixels.getData();
+  for(int y=0; y<h; y++)
+  {
+    const unsigned char * line = in + (size_t)(y * sh / h) * sw * channels;
+    for(int x=0; x<w; x++)
+    {
+      const unsigned char * p = line + (size_t)(x * sw / w) * channels;
+      for(int k=0; k<channels; k++)
+      {
+        *out++ = p[k];
+      }
+    }
+  }
+
+#ifndef OFX_WEBCAM_TRACKER_HEADLESS
+  upload();
+#endif
+}
+
+void ofxWebcamPreview::reset()
+{
+  lastUpdate = -1;
+}
+
+ofPixels & ofxWebcamPreview::getPixels()
+{
+  return pixels;
+}
+
+#ifndef OFX_WEBCAM_TRACKER_HEADLESS
+//Fills one buffer and loads the texture from the one filled last time, so
+//the driver can copy in the background instead of stalling the draw.
+void ofxWebcamPreview::upload()
+{
+  size_t bytes = pixels.getTotalBytes();
+  if(!texture.isAllocated() || texture.getWidth() != pixels.getWidth() || texture.getHeight() != pixels.getHeight())
+  {
+    texture.allocate(pixels);
+    texture.loadData(pixels);
+    bufferSize[0] = 0;
+    bufferSize[1] = 0;
+    loaded = true;
+  }
+
+  if(bufferSize[next] != bytes)
+  {
+    buffers[next].allocate(bytes, GL_STREAM_DRAW);
+    bufferSize[next] = bytes;
+  }
+  buffers[next].updateData(0, bytes, pixels.getData());
+
+  int previous = 1 - next;
+  if(bufferSize[previous] == bytes)
+  {
+    texture.loadData(buffers[previous], ofGetGLFormat(pixels), GL_UNSIGNED_BYTE);
+  }
+  next = previous;
+}
+
+void ofxWebcamPreview::draw(float x, float y, float w, float h)
+{
+  if(loaded)
+  {
+    texture.draw(x, y, w, h);
+  }
+}
+#endif
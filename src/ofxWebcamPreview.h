@@ -0,0 +1,52 @@
+#pragma once
+#include "ofMain.h"
+
+#define DEFAULT_PREVIEW_SCALE 0.5
+#define DEFAULT_PREVIEW_RATE 5
+
+enum ofxWebcamPreviewView {
+  OFX_WEBCAM_PREVIEW_RGB,
+  OFX_WEBCAM_PREVIEW_GRAYSCALE,
+  OFX_WEBCAM_PREVIEW_BACKGROUND,
+  OFX_WEBCAM_PREVIEW_DIFF,
+  OFX_WEBCAM_PREVIEW_COUNT
+};
+
+//A downscaled copy of one of the tracker images, refreshed at a limited
+//rate and only while somebody is looking at it. With a renderer the copy
+//goes to the texture through two pixel buffers, so the upload of one frame
+//overlaps with the drawing of the previous one.
+class ofxWebcamPreview {
+  private:
+    ofPixels pixels;
+    float scale;
+    float rate;
+    float lastUpdate;
+
+#ifndef OFX_WEBCAM_TRACKER_HEADLESS
+    ofBufferObject buffers[2];
+    size_t bufferSize[2];
+    int next;
+    ofTexture texture;
+    bool loaded;
+
+    void upload();
+#endif
+
+  public:
+    ofxWebcamPreview();
+
+    void setScale(float value);
+    void setRate(float fps);
+    float getScale();
+    float getRate();
+
+    bool isDue(float now);
+    void update(const ofPixels & src, float now);
+    void reset();
+    ofPixels & getPixels();
+
+#ifndef OFX_WEBCAM_TRACKER_HEADLESS
+    void draw(float x, float y, float w, float h);
+#endif
+};
@@ -0,0 +1,190 @@
+#include "ofxWebcamRunLabeller.h"
+
+static bool sortByPosition(const ofPoint & a, const ofPoint & b)
+{
+  return a.x < b.x || (a.x == b.x && a.y < b.y);
+}
+
+static float cross(const ofPoint & o, const ofPoint & a, const ofPoint & b)
+{
+  return (a.x - o.x) * (b.y - o.y) - (a.y - o.y) * (b.x - o.x);
+}
+
+ofxWebcamRunLabeller::ofxWebcamRunLabeller(){
+
+}
+
+ofxWebcamRunLabeller::~ofxWebcamRunLabeller(){
+
+}
+
+int ofxWebcamRunLabeller::find(int i)
+{
+  while(parent[i] != i)
+  {
+    parent[i] = parent[parent[i]];
+    i = parent[i];
+  }
+  return i;
+}
+
+void ofxWebcamRunLabeller::join(int a, int b)
+{
+  a = find(a);
+  b = find(b);
+  if(a == b) return;
+  if(a < b) parent[b] = a;
+  else parent[a] = b;
+}
+
+int ofxWebcamRunLabeller::findBlobs(ofxWebcamBinaryMask & mask, int minArea, int maxArea, int maxBlobs, vector<ofxCvBlob> & blobs, vector<vector<ofPoint> > * hulls)
+{
+  blobs.clear();
+  mask.extractRuns(runs);
+
+  int numRuns = runs.size();
+  parent.resize(numRuns);
+  for(int i=0; i<numRuns; i++) parent[i] = i;
+
+  //Walk each row against the previous one; runs touch (8-connected) when
+  //their spans overlap or meet at a corner.
+  int prevStart = 0;
+  int prevEnd = 0;
+  int i = 0;
+  while(i < numRuns)
+  {
+    int y = runs[i].y;
+    int rowStart = i;
+    while(i < numRuns && runs[i].y == y) i++;
+    int rowEnd = i;
+
+    bool hasPrevRow = prevEnd > prevStart && runs[prevStart].y == y - 1;
+    if(hasPrevRow)
+    {
+      int p = prevStart;
+      for(int c=rowStart; c<rowEnd; c++)
+      {
+        while(p < prevEnd && runs[p].end + 1 < runs[c].start) p++;
+        for(int q=p; q<prevEnd && runs[q].start <= runs[c].end + 1; q++)
+        {
+          join(c, q);
+        }
+      }
+    }
+
+    prevStart = rowStart;
+    prevEnd = rowEnd;
+  }
+
+  componentIndex.assign(numRuns, -1);
+  components.clear();
+  for(int r=0; r<numRuns; r++)
+  {
+    int root = find(r);
+    if(componentIndex[root] == -1)
+    {
+      componentIndex[root] = components.size();
+      Component c = {0, 0, 0, runs[r].start, runs[r].y, runs[r].end, runs[r].y};
+      components.push_back(c);
+      if(hulls != NULL)
+      {
+        if(componentPoints.size() < components.size()) componentPoints.resize(components.size());
+        componentPoints[components.size() - 1].clear();
+      }
+    }
+
+    Component & c = components[componentIndex[root]];
+    const ofxWebcamRun & run = runs[r];
+    int64_t length = run.end - run.start + 1;
+    c.area += length;
+    c.sumX += (double)(run.start + run.end) * length / 2.0;
+    c.sumY += (double)run.y * length;
+    c.minX = MIN(c.minX, run.start);
+    c.maxX = MAX(c.maxX, run.end);
+    c.minY = MIN(c.minY, run.y);
+    c.maxY = MAX(c.maxY, run.y);
+
+    //The pixel corners at both ends of every run are all the hull needs.
+    if(hulls != NULL)
+    {
+      vector<ofPoint> & points = componentPoints[componentIndex[root]];
+      points.push_back(ofPoint(run.start, run.y));
+      points.push_back(ofPoint(run.end + 1, run.y));
+      points.push_back(ofPoint(run.start, run.y + 1));
+      points.push_back(ofPoint(run.end + 1, run.y + 1));
+    }
+  }
+
+  order.clear();
+  for(size_t k=0; k<components.size(); k++)
+  {
+    if(components[k].area < minArea || components[k].area > maxArea) continue;
+    order.push_back(k);
+  }
+
+  std::sort(order.begin(), order.end(), [this](int a, int b){
+    return components[a].area > components[b].area;
+  });
+  if((int)order.size() > maxBlobs)
+  {
+    order.resize(maxBlobs);
+  }
+
+  if(hulls != NULL)
+  {
+    hulls->resize(order.size());
+  }
+
+  for(size_t n=0; n<order.size(); n++)
+  {
+    Component & c = components[order[n]];
+
+    ofxCvBlob blob;
+    blob.area = c.area;
+    blob.length = 2 * ((c.maxX - c.minX + 1) + (c.maxY - c.minY + 1));
+    blob.boundingRect.set(c.minX, c.minY, c.maxX - c.minX + 1, c.maxY - c.minY + 1);
+    blob.centroid.x = c.sumX / c.area + 0.5;
+    blob.centroid.y = c.sumY / c.area + 0.5;
+    blob.hole = false;
+    blob.nPts = 0;
+    blobs.push_back(blob);
+
+    if(hulls != NULL)
+    {
+      convexHull(componentPoints[order[n]], (*hulls)[n]);
+    }
+  }
+
+  return blobs.size();
+}
+
+//Andrew's monotone chain, counter-clockwise in image coordinates. Sorts points.
+void ofxWebcamRunLabeller::convexHull(vector<ofPoint> & points, vector<ofPoint> & hull)
+{
+  int n = points.size();
+  if(n < 3)
+  {
+    hull = points;
+    return;
+  }
+
+  std::sort(points.begin(), points.end(), sortByPosition);
+  hull.resize(2 * n);
+  int k = 0;
+  for(int i=0; i<n; i++)
+  {
+    while(k >= 2 && cross(hull[k-2], hull[k-1], points[i]) <= 0) k--;
+    hull[k++] = points[i];
+  }
+  for(int i=n-2, lower=k+1; i>=0; i--)
+  {
+    while(k >= lower && cross(hull[k-2], hull[k-1], points[i]) <= 0) k--;
+    hull[k++] = points[i];
+  }
+  hull.resize(k - 1);
+}
+
+vector<ofxWebcamRun> & ofxWebcamRunLabeller::getRuns()
+{
+  return runs;
+}
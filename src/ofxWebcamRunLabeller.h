@@ -0,0 +1,40 @@
+#pragma once
+#include "ofxOpenCv.h"
+#include "ofxWebcamBinaryMask.h"
+
+//Finds 8-connected blobs in a packed mask by joining overlapping runs of
+//consecutive rows, without ever expanding the mask to 8 bits.
+//Blobs come out like ofxCvContourFinder's, sorted by area, with centroid,
+//area and boundingRect filled but no contour points. The convex hull of
+//each blob can be collected on the way for little extra work.
+class ofxWebcamRunLabeller {
+  private:
+    struct Component {
+      int64_t area;
+      double sumX;
+      double sumY;
+      int minX;
+      int minY;
+      int maxX;
+      int maxY;
+    };
+
+    vector<ofxWebcamRun> runs;
+    vector<int> parent;
+    vector<int> componentIndex;
+    vector<Component> components;
+    vector<int> order;
+    vector<vector<ofPoint> > componentPoints;
+
+    int find(int i);
+    void join(int a, int b);
+
+  public:
+    ofxWebcamRunLabeller();
+    ~ofxWebcamRunLabeller();
+
+    int findBlobs(ofxWebcamBinaryMask & mask, int minArea, int maxArea, int maxBlobs, vector<ofxCvBlob> & blobs, vector<vector<ofPoint> > * hulls=NULL);
+    vector<ofxWebcamRun> & getRuns();
+
+    static void convexHull(vector<ofPoint> & points, vector<ofPoint> & hull);
+};
@@ -0,0 +1,142 @@
+#include "ofxWebcamShadowFilter.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+static inline int ctz64(uint64_t v) { unsigned long i; _BitScanForward64(&i, v); return (int)i; }
+#else
+static inline int ctz64(uint64_t v) { return __builtin_ctzll(v); }
+#endif
+
+ofxWebcamShadowFilter::ofxWebcamShadowFilter(){
+  minBrightness = DEFAULT_SHADOW_MIN_BRIGHTNESS;
+  maxBrightness = DEFAULT_SHADOW_MAX_BRIGHTNESS;
+  chromaTolerance = DEFAULT_SHADOW_CHROMA_TOLERANCE;
+}
+
+ofxWebcamShadowFilter::~ofxWebcamShadowFilter(){
+
+}
+
+void ofxWebcamShadowFilter::setBackground(const ofPixels & rgb)
+{
+  background = rgb;
+}
+
+bool ofxWebcamShadowFilter::hasBackground()
+{
+  return background.isAllocated();
+}
+
+void ofxWebcamShadowFilter::clear()
+{
+  background.clear();
+}
+
+void ofxWebcamShadowFilter::setBrightnessRange(float low, float high)
+{
+  minBrightness = MAX(0, low);
+  maxBrightness = MAX(minBrightness, high);
+}
+
+void ofxWebcamShadowFilter::setChromaTolerance(float value)
+{
+  chromaTolerance = MAX(0, value);
+}
+
+float ofxWebcamShadowFilter::getMinBrightness()
+{
+  return minBrightness;
+}
+
+float ofxWebcamShadowFilter::getMaxBrightness()
+{
+  return maxBrightness;
+}
+
+float ofxWebcamShadowFilter::getChromaTolerance()
+{
+  return chromaTolerance;
+}
+
+//Cross multiplied so there is no division per pixel:
+//  sum(p) / sum(b) in [min, max]  and  |r(p) - r(b)| + |g(p) - g(b)| <= tolerance
+//Background pixels too dark to have a reliable chroma are never shadows.
+inline bool ofxWebcamShadowFilter::isShadow(const unsigned char * p, const unsigned char * b)
+{
+  int sp = p[0] + p[1] + p[2];
+  int sb = b[0] + b[1] + b[2];
+  if(sb < SHADOW_MIN_BACKGROUND_SUM || sp == 0) return false;
+  if(sp < minBrightness * sb || sp > maxBrightness * sb) return false;
+
+  int dr = abs(p[0] * sb - b[0] * sp);
+  int dg = abs(p[1] * sb - b[1] * sp);
+  return dr + dg <= chromaTolerance * sp * sb;
+}
+
+//Returns the number of pixels removed from the mask.
+size_t ofxWebcamShadowFilter::apply(const ofPixels & rgb, ofxWebcamBinaryMask & mask)
+{
+  int width = mask.getWidth();
+  int height = mask.getHeight();
+  if(!hasBackground() || rgb.getNumChannels() < 3 || (int)rgb.getWidth() != width || (int)rgb.getHeight() != height
+     || background.getWidth() != rgb.getWidth() || background.getHeight() != rgb.getHeight())
+  {
+    return 0;
+  }
+
+  int channels = rgb.getNumChannels();
+  int backgroundChannels = background.getNumChannels();
+  const unsigned char * in = rgb.getData();
+  const unsigned char * bg = background.getData();
+  int words = mask.getWordsPerRow();
+  size_t removed = 0;
+
+  for(int y=0; y<height; y++)
+  {
+    uint64_t * row = mask.getRow(y);
+    size_t line = (size_t)y * width;
+    for(int w=0; w<words; w++)
+    {
+      uint64_t bits = row[w];
+      while(bits)
+      {
+        int i = ctz64(bits);
+        bits &= bits - 1;
+        size_t x = line + w * 64 + i;
+        if(isShadow(in + x * channels, bg + x * backgroundChannels))
+        {
+          row[w] &= ~(1ULL << i);
+          removed++;
+        }
+      }
+    }
+  }
+  return removed;
+}
+
+size_t ofxWebcamShadowFilter::apply(const ofPixels & rgb, ofPixels & diff)
+{
+  if(!hasBackground() || rgb.getNumChannels() < 3 || rgb.getWidth() != diff.getWidth() || rgb.getHeight() != diff.getHeight()
+     || background.getWidth() != rgb.getWidth() || background.getHeight() != rgb.getHeight())
+  {
+    return 0;
+  }
+
+  int channels = rgb.getNumChannels();
+  int backgroundChannels = background.getNumChannels();
+  const unsigned char * in = rgb.getData();
+  const unsigned char * bg = background.getData();
+  unsigned char * d = diff.getData();
+  size_t count = diff.getWidth() * diff.getHeight();
+  size_t removed = 0;
+
+  for(size_t x=0; x<count; x++)
+  {
+    if(d[x] && isShadow(in + x * channels, bg + x * backgroundChannels))
+    {
+      d[x] = 0;
+      removed++;
+    }
+  }
+  return removed;
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include "ofMain.h"
+#include "ofxWebcamBinaryMask.h"
+
+#define DEFAULT_SHADOW_MIN_BRIGHTNESS 0.4
+#define DEFAULT_SHADOW_MAX_BRIGHTNESS 1.0
+#define DEFAULT_SHADOW_CHROMA_TOLERANCE 0.04
+#define SHADOW_MIN_BACKGROUND_SUM 45
+
+//Removes shadow pixels from a foreground mask by comparing the RGB frame
+//with an RGB background. A pixel is a shadow when its brightness is a
+//fraction of the background's within the brightness range and its
+//normalized chromaticity (r, g) = (R, G) / (R + G + B) stayed the same.
+//A range reaching above 1 also removes pixels that only got brighter.
+//Only pixels already in the mask are tested.
+class ofxWebcamShadowFilter {
+  private:
+    ofPixels background;
+    float minBrightness;
+    float maxBrightness;
+    float chromaTolerance;
+
+    inline bool isShadow(const unsigned char * p, const unsigned char * b);
+
+  public:
+    ofxWebcamShadowFilter();
+    ~ofxWebcamShadowFilter();
+
+    void setBackground(const ofPixels & rgb);
+    bool hasBackground();
+    void clear();
+
+    void setBrightnessRange(float low, float high);
+    void setChromaTolerance(float value);
+    float getMinBrightness();
+    float getMaxBrightness();
+    float getChromaTolerance();
+
+    size_t apply(const ofPixels & rgb, ofxWebcamBinaryMask & mask);
+    size_t apply(const ofPixels & rgb, ofPixels & diff);
+};
@@ -0,0 +1,161 @@
+#include "ofxWebcamSnapshot.h"
+
+ofxWebcamSnapshotRef::ofxWebcamSnapshotRef() : buffer(NULL), slot(-1) {
+
+}
+
+ofxWebcamSnapshotRef::ofxWebcamSnapshotRef(ofxWebcamSnapshotBuffer * buffer, int slot) : buffer(buffer), slot(slot) {
+
+}
+
+ofxWebcamSnapshotRef::ofxWebcamSnapshotRef(ofxWebcamSnapshotRef && other) : buffer(other.buffer), slot(other.slot) {
+  other.buffer = NULL;
+  other.slot = -1;
+}
+
+ofxWebcamSnapshotRef & ofxWebcamSnapshotRef::operator=(ofxWebcamSnapshotRef && other)
+{
+  if(this != &other)
+  {
+    release();
+    buffer = other.buffer;
+    slot = other.slot;
+    other.buffer = NULL;
+    other.slot = -1;
+  }
+  return *this;
+}
+
+ofxWebcamSnapshotRef::~ofxWebcamSnapshotRef(){
+  release();
+}
+
+void ofxWebcamSnapshotRef::release()
+{
+  if(buffer != NULL)
+  {
+    buffer->slots[slot].readers.fetch_sub(1, std::memory_order_release);
+    buffer = NULL;
+    slot = -1;
+  }
+}
+
+bool ofxWebcamSnapshotRef::isValid() const
+{
+  return buffer != NULL;
+}
+
+const ofxWebcamSnapshot & ofxWebcamSnapshotRef::get() const
+{
+  return buffer->slots[slot].snapshot;
+}
+
+const ofxWebcamSnapshot * ofxWebcamSnapshotRef::operator->() const
+{
+  return &buffer->slots[slot].snapshot;
+}
+
+ofxWebcamSnapshotBuffer::ofxWebcamSnapshotBuffer(int numSlots) : numSlots(MAX(2, numSlots)), latest(0), skipped(0) {
+  slots.reset(new Slot[this->numSlots]);
+  for(int i=0; i<this->numSlots; i++)
+  {
+    slots[i].snapshot.frame = 0;
+    slots[i].snapshot.captureTime = 0;
+    slots[i].readers = 0;
+  }
+}
+
+ofxWebcamSnapshotBuffer::~ofxWebcamSnapshotBuffer(){
+
+}
+
+//Called by the tracker only, from one thread at a time. False if every
+//slot was being read and the frame was skipped.
+bool ofxWebcamSnapshotBuffer::publish(uint64_t frame, float captureTime, vector<ofxWebcamBlob> & blobs)
+{
+  int current = latest.load(std::memory_order_relaxed);
+  int slot = -1;
+  for(int i=1; i<numSlots; i++)
+  {
+    int candidate = (current + i) % numSlots;
+    //Pairs with the check in acquire(): a reader that arrives after this
+    //sees another slot as the latest and backs off.
+    if(slots[candidate].readers.load(std::memory_order_seq_cst) == 0)
+    {
+      slot = candidate;
+      break;
+    }
+  }
+  if(slot == -1)
+  {
+    skipped.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+
+  ofxWebcamSnapshot & s = slots[slot].snapshot;
+  s.frame = frame;
+  s.captureTime = captureTime;
+  s.blobs.resize(blobs.size());
+  for(size_t i=0; i<blobs.size(); i++)
+  {
+    ofxWebcamBlob & b = blobs[i];
+    ofxWebcamSnapshotBlob & out = s.blobs[i];
+    out.id = b.id;
+    out.centroid = ofVec2f(b.blob.centroid.x, b.blob.centroid.y);
+    out.boundingRect = b.blob.boundingRect;
+    out.area = b.blob.area;
+    out.velocity = b.velocity;
+    out.time = b.getCaptureTime();
+    out.previousCentroid = b.getPreviousCentroid();
+    out.previousTime = b.getPreviousCaptureTime();
+    out.active = b.isActive();
+    out.overlapping = b.isOverlapping();
+    out.mergedInto = b.getMergedInto();
+  }
+
+  latest.store(slot, std::memory_order_seq_cst);
+  return true;
+}
+
+//The latest snapshot, from any thread. Only retries when the tracker
+//published in between, which it does once per frame.
+ofxWebcamSnapshotRef ofxWebcamSnapshotBuffer::acquire()
+{
+  while(true)
+  {
+    int slot = latest.load(std::memory_order_seq_cst);
+    slots[slot].readers.fetch_add(1, std::memory_order_seq_cst);
+    if(latest.load(std::memory_order_seq_cst) == slot)
+    {
+      return ofxWebcamSnapshotRef(this, slot);
+    }
+    slots[slot].readers.fetch_sub(1, std::memory_order_release);
+  }
+}
+
+//The active blobs of the latest snapshot moved to where they are at time,
+//see ofxWebcamSnapshotBlob::getCentroidAt(). Only reads the snapshot, so it
+//is as cheap as copying the blobs and can run at any rate on any thread.
+int ofxWebcamSnapshotBuffer::getBlobsAt(float time, float horizon, vector<ofxWebcamSnapshotBlob> & out)
+{
+  out.clear();
+  ofxWebcamSnapshotRef snapshot = acquire();
+  const vector<ofxWebcamSnapshotBlob> & blobs = snapshot->blobs;
+  for(size_t i=0; i<blobs.size(); i++)
+  {
+    if(!blobs[i].active) continue;
+    out.push_back(blobs[i]);
+    ofxWebcamSnapshotBlob & b = out.back();
+    ofVec2f delta = b.getCentroidAt(time, horizon) - b.centroid;
+    b.centroid += delta;
+    b.boundingRect.x += delta.x;
+    b.boundingRect.y += delta.y;
+  }
+  return out.size();
+}
+
+//Frames that were not published because every slot was being read.
+uint64_t ofxWebcamSnapshotBuffer::getSkipped()
+{
+  return skipped.load(std::memory_order_relaxed);
+}
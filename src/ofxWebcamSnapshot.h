@@ -0,0 +1,97 @@
+#pragma once
+#include "ofMain.h"
+#include "ofxWebcamBlob.h"
+
+#define DEFAULT_SNAPSHOT_SLOTS 4
+
+//What other threads see of a blob.
+struct ofxWebcamSnapshotBlob {
+  int id;
+  ofVec2f centroid;
+  ofRectangle boundingRect;
+  float area;
+  ofVec2f velocity;  //pixels per second
+  float time;        //capture time of the last update, in seconds
+  ofVec2f previousCentroid;
+  float previousTime;
+  bool active;
+  bool overlapping;
+  int mergedInto;
+
+  //Centroid at any time on the capture clock: interpolated between the last
+  //two updates, held before them, and carried along the velocity after the
+  //last one for at most horizon seconds.
+  ofVec2f getCentroidAt(float t, float horizon) const
+  {
+    if(t >= time)
+    {
+      return centroid + velocity * MIN(t - time, horizon);
+    }
+    if(t <= previousTime || time <= previousTime)
+    {
+      return previousCentroid;
+    }
+    return previousCentroid + (centroid - previousCentroid) * ((t - previousTime) / (time - previousTime));
+  }
+};
+
+//The blobs of one frame. Never changes while anyone holds it.
+struct ofxWebcamSnapshot {
+  uint64_t frame;
+  float captureTime;
+  vector<ofxWebcamSnapshotBlob> blobs;
+};
+
+class ofxWebcamSnapshotBuffer;
+
+//A snapshot held by a reader. The slot it lives in is not reused until the
+//reference goes away, so keep it only as long as it is needed.
+class ofxWebcamSnapshotRef {
+  private:
+    ofxWebcamSnapshotBuffer * buffer;
+    int slot;
+
+  public:
+    ofxWebcamSnapshotRef();
+    ofxWebcamSnapshotRef(ofxWebcamSnapshotBuffer * buffer, int slot);
+    ofxWebcamSnapshotRef(ofxWebcamSnapshotRef && other);
+    ofxWebcamSnapshotRef & operator=(ofxWebcamSnapshotRef && other);
+    ofxWebcamSnapshotRef(const ofxWebcamSnapshotRef &) = delete;
+    ofxWebcamSnapshotRef & operator=(const ofxWebcamSnapshotRef &) = delete;
+    ~ofxWebcamSnapshotRef();
+
+    void release();
+    bool isValid() const;
+    const ofxWebcamSnapshot & get() const;
+    const ofxWebcamSnapshot * operator->() const;
+};
+
+//Publishes the tracker's blobs to any number of reader threads without a
+//lock. The tracker writes each frame into a slot nobody is reading and then
+//makes it the latest one. Readers count themselves into the latest slot and
+//check it is still the latest. Neither side ever waits for the other. If every
+//slot is being read, the frame is not published and readers keep the one
+//before.
+class ofxWebcamSnapshotBuffer {
+  private:
+    struct Slot {
+      ofxWebcamSnapshot snapshot;
+      std::atomic<int> readers;
+    };
+
+    std::unique_ptr<Slot[]> slots;
+    int numSlots;
+    std::atomic<int> latest;
+    std::atomic<uint64_t> skipped;
+
+    friend class ofxWebcamSnapshotRef;
+
+  public:
+    ofxWebcamSnapshotBuffer(int numSlots=DEFAULT_SNAPSHOT_SLOTS);
+    ~ofxWebcamSnapshotBuffer();
+
+    bool publish(uint64_t frame, float captureTime, vector<ofxWebcamBlob> & blobs);
+    ofxWebcamSnapshotRef acquire();
+    int getBlobsAt(float time, float horizon, vector<ofxWebcamSnapshotBlob> & out);
+    uint64_t getSkipped();
+};
@@ -0,0 +1,427 @@
+#include "ofxWebcamSyntheticScene.h"
+
+ofxWebcamSyntheticScene::ofxWebcamSyntheticScene(){
+  width = 0;
+  height = 0;
+  state = 1;
+  idCounter = 0;
+  frame = 0;
+  fps = DEFAULT_SYNTHETIC_FPS;
+  minSpeed = 20;
+  maxSpeed = 120;
+  minRadius = ofVec2f(12, 24);
+  maxRadius = ofVec2f(22, 40);
+  drift = DEFAULT_SYNTHETIC_DRIFT;
+  driftPeriod = DEFAULT_SYNTHETIC_DRIFT_PERIOD;
+  groupChance = DEFAULT_SYNTHETIC_GROUP_CHANCE;
+}
+
+ofxWebcamSyntheticScene::~ofxWebcamSyntheticScene(){
+
+}
+
+//xorshift32, so runs do not depend on the platform's rand().
+uint32_t ofxWebcamSyntheticScene::next()
+{
+  state ^= state << 13;
+  state ^= state >> 17;
+  state ^= state << 5;
+  return state;
+}
+
+float ofxWebcamSyntheticScene::random(float low, float high)
+{
+  return low + (high - low) * (next() / 4294967296.0);
+}
+
+void ofxWebcamSyntheticScene::setup(int worldWidth, int worldHeight, int numPeople, uint32_t seed)
+{
+  width = worldWidth;
+  height = worldHeight;
+  state = seed != 0 ? seed : 1;
+  idCounter = 0;
+  frame = 0;
+
+  //Floor tiles under a soft light pattern, slightly tinted.
+  base.resize((size_t)width * height * 3);
+  float phaseX = random(0, TWO_PI);
+  float phaseY = random(0, TWO_PI);
+  for(int y=0; y<height; y++)
+  {
+    for(int x=0; x<width; x++)
+    {
+      float light = 100 + 40 * sin(x * 0.013 + phaseX) * cos(y * 0.021 + phaseY);
+      float tile = (((x / 40) + (y / 40)) & 1) ? 12 : -12;
+      float v = light + tile;
+      unsigned char * p = &base[((size_t)y * width + x) * 3];
+      p[0] = (unsigned char)ofClamp(v * 1.05, 0, 255);
+      p[1] = (unsigned char)ofClamp(v, 0, 255);
+      p[2] = (unsigned char)ofClamp(v * 0.9, 0, 255);
+    }
+  }
+
+  people.resize(MAX(0, numPeople));
+  for(size_t i=0; i<people.size(); i++)
+  {
+    spawn(people[i], true);
+  }
+  updateTruth();
+}
+
+void ofxWebcamSyntheticScene::setFrameRate(float value)
+{
+  fps = MAX(1, value);
+}
+
+//Pixels per second.
+void ofxWebcamSyntheticScene::setSpeed(float low, float high)
+{
+  minSpeed = MAX(0, low);
+  maxSpeed = MAX(minSpeed, high);
+}
+
+void ofxWebcamSyntheticScene::setPersonSize(ofVec2f low, ofVec2f high)
+{
+  minRadius = low;
+  maxRadius = high;
+}
+
+//Background brightness swings by amplitude (0.15 is +-15%) over the period.
+void ofxWebcamSyntheticScene::setDrift(float amplitude, float periodSeconds)
+{
+  drift = MAX(0, amplitude);
+  driftPeriod = MAX(0.001f, periodSeconds);
+}
+
+//Chance per second that two people who meet walk on together.
+void ofxWebcamSyntheticScene::setGroupChance(float value)
+{
+  groupChance = MAX(0, value);
+}
+
+//A new person, either anywhere in the world or entering from a side.
+void ofxWebcamSyntheticScene::spawn(Person & p, bool anywhere)
+{
+  p.id = ++idCounter;
+  p.radius = ofVec2f(random(minRadius.x, maxRadius.x), random(minRadius.y, maxRadius.y));
+  p.partner = -1;
+  p.together = 0;
+  for(int k=0; k<3; k++)
+  {
+    p.color[k] = (next() & 1) ? (unsigned char)random(170, 255) : (unsigned char)random(0, 60);
+  }
+
+  float speed = random(minSpeed, maxSpeed);
+  if(anywhere)
+  {
+    float angle = random(0, TWO_PI);
+    p.position = ofVec2f(random(p.radius.x, width - p.radius.x), random(p.radius.y, height - p.radius.y));
+    p.velocity = ofVec2f(cos(angle), sin(angle)) * speed;
+  }
+  else
+  {
+    bool fromLeft = next() & 1;
+    float angle = random(-0.5, 0.5);
+    p.position = ofVec2f(fromLeft ? -p.radius.x : width + p.radius.x, random(p.radius.y, height - p.radius.y));
+    p.velocity = ofVec2f(cos(angle) * (fromLeft ? 1 : -1), sin(angle)) * speed;
+  }
+}
+
+void ofxWebcamSyntheticScene::advance()
+{
+  frame++;
+  float dt = 1.0 / fps;
+
+  for(size_t i=0; i<people.size(); i++)
+  {
+    Person & p = people[i];
+
+    if(p.partner != -1)
+    {
+      p.together -= dt;
+      if(p.together <= 0)
+      {
+        //Part ways, one to each side.
+        Person & other = people[p.partner];
+        ofVec2f side(-p.velocity.y, p.velocity.x);
+        side.normalize();
+        float push = MAX(minSpeed, p.velocity.length() * 0.5);
+        p.velocity += side * push;
+        other.velocity -= side * push;
+        other.partner = -1;
+        other.together = 0;
+        p.partner = -1;
+      }
+    }
+    else if(next() % 100 == 0)
+    {
+      p.velocity.rotate(random(-30, 30));
+    }
+
+    p.position += p.velocity * dt;
+
+    if(p.position.y < p.radius.y)
+    {
+      p.position.y = p.radius.y;
+      p.velocity.y = fabs(p.velocity.y);
+    }
+    else if(p.position.y > height - p.radius.y)
+    {
+      p.position.y = height - p.radius.y;
+      p.velocity.y = -fabs(p.velocity.y);
+    }
+
+    if(p.position.x < -p.radius.x * 2 || p.position.x > width + p.radius.x * 2)
+    {
+      if(p.partner != -1)
+      {
+        people[p.partner].partner = -1;
+      }
+      spawn(p, false);
+    }
+  }
+
+  //People who meet may walk on together for a few seconds.
+  for(size_t i=0; i<people.size(); i++)
+  {
+    Person & a = people[i];
+    if(a.partner != -1) continue;
+    for(size_t j=i+1; j<people.size(); j++)
+    {
+      Person & b = people[j];
+      if(b.partner != -1) continue;
+      float reach = (a.radius.x + b.radius.x) * 1.2;
+      if(a.position.squareDistance(b.position) > reach * reach) continue;
+      if(random(0, 1) >= groupChance * dt) continue;
+
+      ofVec2f shared = (a.velocity + b.velocity) / 2;
+      if(shared.length() < minSpeed)
+      {
+        shared = a.velocity;
+      }
+      a.velocity = shared;
+      b.velocity = shared;
+      a.partner = j;
+      b.partner = i;
+      a.together = b.together = random(1, 4);
+      break;
+    }
+  }
+
+  updateTruth();
+}
+
+void ofxWebcamSyntheticScene::updateTruth()
+{
+  truth.resize(people.size());
+  for(size_t i=0; i<people.size(); i++)
+  {
+    truth[i].id = people[i].id;
+    truth[i].position = people[i].position;
+    truth[i].radius = people[i].radius;
+    truth[i].visible = people[i].position.x >= 0 && people[i].position.x < width;
+  }
+}
+
+//Renders the part of the world seen through view. Each camera can have its
+//own noise level and seed, so cameras do not share the same grain.
+void ofxWebcamSyntheticScene::render(const ofRectangle & view, float noise, ofPixels & out, uint32_t cameraSeed)
+{
+  int w = view.width;
+  int h = view.height;
+  int ox = view.x;
+  int oy = view.y;
+  if((int)out.getWidth() != w || (int)out.getHeight() != h || out.getNumChannels() != 3)
+  {
+    out.allocate(w, h, OF_PIXELS_RGB);
+  }
+  unsigned char * pix = out.getData();
+
+  float gain = 1.0 + drift * sin(TWO_PI * getTime() / driftPeriod + cameraSeed);
+  for(int y=0; y<h; y++)
+  {
+    for(int x=0; x<w; x++)
+    {
+      int wx = x + ox;
+      int wy = y + oy;
+      unsigned char * o = pix + ((size_t)y * w + x) * 3;
+      if(wx < 0 || wy < 0 || wx >= width || wy >= height)
+      {
+        o[0] = o[1] = o[2] = 0;
+        continue;
+      }
+      const unsigned char * b = &base[((size_t)wy * width + wx) * 3];
+      for(int k=0; k<3; k++)
+      {
+        o[k] = (unsigned char)MIN(255.0f, b[k] * gain);
+      }
+    }
+  }
+
+  for(size_t i=0; i<people.size(); i++)
+  {
+    const Person & p = people[i];
+    int x0 = MAX(0, (int)floor(p.position.x - p.radius.x) - ox);
+    int x1 = MIN(w - 1, (int)ceil(p.position.x + p.radius.x) - ox);
+    int y0 = MAX(0, (int)floor(p.position.y - p.radius.y) - oy);
+    int y1 = MIN(h - 1, (int)ceil(p.position.y + p.radius.y) - oy);
+    for(int y=y0; y<=y1; y++)
+    {
+      float dy = (y + oy + 0.5f - p.position.y) / p.radius.y;
+      for(int x=x0; x<=x1; x++)
+      {
+        float dx = (x + ox + 0.5f - p.position.x) / p.radius.x;
+        float d = dx*dx + dy*dy;
+        if(d > 1) continue;
+        float shade = 0.75 + 0.25 * (1 - d);
+        unsigned char * o = pix + ((size_t)y * w + x) * 3;
+        for(int k=0; k<3; k++)
+        {
+          o[k] = (unsigned char)(p.color[k] * shade);
+        }
+      }
+    }
+  }
+
+  //Roughly normal sensor noise: the sum of four uniform bytes has a
+  //standard deviation of about 147.8.
+  if(noise > 0)
+  {
+    uint32_t grain = (uint32_t)(frame * 2654435761u) ^ (cameraSeed * 40503u) ^ 0x9E3779B9u;
+    if(grain == 0) grain = 1;
+    float scale = noise / 147.8f;
+    size_t count = (size_t)w * h;
+    for(size_t i=0; i<count; i++)
+    {
+      grain ^= grain << 13;
+      grain ^= grain >> 17;
+      grain ^= grain << 5;
+      int sum = (grain & 255) + ((grain >> 8) & 255) + ((grain >> 16) & 255) + (grain >> 24);
+      int n = (int)((sum - 510) * scale);
+      unsigned char * o = pix + i * 3;
+      for(int k=0; k<3; k++)
+      {
+        o[k] = (unsigned char)ofClamp(o[k] + n, 0, 255);
+      }
+    }
+  }
+}
+
+uint64_t ofxWebcamSyntheticScene::getFrameNumber()
+{
+  return frame;
+}
+
+float ofxWebcamSyntheticScene::getTime()
+{
+  return frame / fps;
+}
+
+float ofxWebcamSyntheticScene::getFrameRate()
+{
+  return fps;
+}
+
+int ofxWebcamSyntheticScene::getWidth()
+{
+  return width;
+}
+
+int ofxWebcamSyntheticScene::getHeight()
+{
+  return height;
+}
+
+vector<ofxWebcamTruth> & ofxWebcamSyntheticScene::getTruth()
+{
+  return truth;
+}
+
+//position is where this camera's image starts in the world. Put cameras
+//side by side, like ofxWebcamArray does, and the truth is in stitched
+//image coordinates.
+ofxWebcamSyntheticSource::ofxWebcamSyntheticSource(shared_ptr<ofxWebcamSyntheticScene> scene, ofVec2f position, float noise, uint32_t cameraSeed){
+  this->scene = scene;
+  this->view = ofRectangle(position.x, position.y, 0, 0);
+  this->noise = noise;
+  this->cameraSeed = cameraSeed;
+  renderedFrame = 0;
+  fresh = false;
+  initialized = false;
+  outageStart = -1;
+  outageEnd = -1;
+}
+
+bool ofxWebcamSyntheticSource::setup(int width, int height)
+{
+  if(inOutage()) return false;
+  view.width = width;
+  view.height = height;
+  initialized = true;
+  return true;
+}
+
+void ofxWebcamSyntheticSource::update()
+{
+  if(inOutage())
+  {
+    fresh = false;
+    return;
+  }
+  fresh = !pixels.isAllocated() || scene->getFrameNumber() != renderedFrame;
+  if(fresh)
+  {
+    scene->render(view, noise, pixels, cameraSeed);
+    renderedFrame = scene->getFrameNumber();
+  }
+}
+
+bool ofxWebcamSyntheticSource::isFrameNew()
+{
+  return fresh;
+}
+
+ofPixels & ofxWebcamSyntheticSource::getPixels()
+{
+  return pixels;
+}
+
+ofPixelFormat ofxWebcamSyntheticSource::getPixelFormat()
+{
+  return OF_PIXELS_RGB;
+}
+
+void ofxWebcamSyntheticSource::close()
+{
+  initialized = false;
+}
+
+bool ofxWebcamSyntheticSource::isInitialized()
+{
+  return initialized;
+}
+
+//The scene's clock; frame 0 is stamped on arrival, so advance first.
+uint64_t ofxWebcamSyntheticSource::getCaptureTime()
+{
+  return (uint64_t)(scene->getTime() * 1000000.0);
+}
+
+bool ofxWebcamSyntheticSource::isSimulated()
+{
+  return true;
+}
+
+//Simulates a camera that is unplugged for a while, in scene seconds: no
+//frames come and it cannot be opened again until the outage is over.
+void ofxWebcamSyntheticSource::setOutage(float startSeconds, float durationSeconds)
+{
+  outageStart = startSeconds;
+  outageEnd = startSeconds + MAX(0, durationSeconds);
+}
+
+bool ofxWebcamSyntheticSource::inOutage()
+{
+  float now = scene->getTime();
+  return now >= outageStart && now < outageEnd;
+}
@@ -0,0 +1,112 @@
+#pragma once
+#include "ofMain.h"
+#include "ofxWebcamFrameSource.h"
+
+#define DEFAULT_SYNTHETIC_FPS 30
+#define DEFAULT_SYNTHETIC_NOISE 4.0
+#define DEFAULT_SYNTHETIC_DRIFT 0.15
+#define DEFAULT_SYNTHETIC_DRIFT_PERIOD 60.0
+#define DEFAULT_SYNTHETIC_GROUP_CHANCE 0.3
+
+//Where a simulated person really is, in stitched image coordinates.
+struct ofxWebcamTruth {
+  int id;
+  ofVec2f position;
+  ofVec2f radius;
+  bool visible;
+};
+
+//A world of elliptical "people" walking over a textured background whose
+//brightness drifts slowly. People bounce off the top and bottom and leave
+//at the sides, coming back in as new people. Some of those who meet walk
+//together for a while and split again, so the tracker sees merges and splits.
+//Everything, including the clock, is driven by advance() and a seed, so a
+//run can be repeated exactly.
+class ofxWebcamSyntheticScene {
+  private:
+    struct Person {
+      int id;
+      ofVec2f position;
+      ofVec2f velocity;
+      ofVec2f radius;
+      unsigned char color[3];
+      int partner;
+      float together;
+    };
+
+    int width;
+    int height;
+    vector<Person> people;
+    vector<ofxWebcamTruth> truth;
+    vector<unsigned char> base;
+    uint32_t state;
+    int idCounter;
+    uint64_t frame;
+    float fps;
+    float minSpeed;
+    float maxSpeed;
+    ofVec2f minRadius;
+    ofVec2f maxRadius;
+    float drift;
+    float driftPeriod;
+    float groupChance;
+
+    uint32_t next();
+    float random(float low, float high);
+    void spawn(Person & p, bool anywhere);
+    void updateTruth();
+
+  public:
+    ofxWebcamSyntheticScene();
+    ~ofxWebcamSyntheticScene();
+
+    void setup(int worldWidth, int worldHeight, int numPeople, uint32_t seed=1);
+    void setFrameRate(float value);
+    void setSpeed(float low, float high);
+    void setPersonSize(ofVec2f low, ofVec2f high);
+    void setDrift(float amplitude, float periodSeconds);
+    void setGroupChance(float value);
+
+    void advance();
+    void render(const ofRectangle & view, float noise, ofPixels & out, uint32_t cameraSeed=0);
+
+    uint64_t getFrameNumber();
+    float getTime();
+    float getFrameRate();
+    int getWidth();
+    int getHeight();
+    vector<ofxWebcamTruth> & getTruth();
+};
+
+//One camera looking at part of a synthetic scene. The scene has to be
+//advanced by the caller; every advance gives each source one new frame.
+class ofxWebcamSyntheticSource : public ofxWebcamFrameSource {
+  private:
+    shared_ptr<ofxWebcamSyntheticScene> scene;
+    ofRectangle view;
+    float noise;
+    uint32_t cameraSeed;
+    ofPixels pixels;
+    uint64_t renderedFrame;
+    bool fresh;
+    bool initialized;
+    float outageStart;
+    float outageEnd;
+
+    bool inOutage();
+
+  public:
+    ofxWebcamSyntheticSource(shared_ptr<ofxWebcamSyntheticScene> scene, ofVec2f position, float noise=DEFAULT_SYNTHETIC_NOISE, uint32_t cameraSeed=0);
+
+    bool setup(int width, int height);
+    void update();
+    bool isFrameNew();
+    ofPixels & getPixels();
+    ofPixelFormat getPixelFormat();
+    void close();
+    bool isInitialized();
+    uint64_t getCaptureTime();
+    bool isSimulated();
+
+    void setOutage(float startSeconds, float durationSeconds);
+};
@@ -2,47 +2,76 @@
 
 ofxWebcamTracker::ofxWebcamTracker() {
   initialized = false;
+  width = 0;
+  height = 0;
   tolerance = 50;
   edgeThreshold = 10.0f;
+  maxBlobs = 20;
+  contourScale = 1.0;
+  frameNumber = 0;
+  morphology = OFX_WEBCAM_MORPHOLOGY_NONE;
+  morphologyRadius = 1;
+  morphologyTime = 0;
+  contourTime = 0;
+  packedMask = false;
+  blobAttributes = OFX_WEBCAM_BLOB_CONTOUR;
+  adaptiveThreshold = false;
+  shadowSuppression = false;
+  shadowTime = 0;
+  shadowPixels = 0;
+  opticalFlow = false;
+  flowTime = 0;
+  predictionHorizon = 0.1;
+  reidentification = false;
+  reidentificationTime = 30;
+  reidentificationDistance = 0.3;
+  adaptiveDirty = true;
+  adaptiveTilesX = 1;
+  adaptiveTilesY = 1;
+  diffStale = false;
+  colorStale = false;
+  trajectories.setup();
+  heatmapEnabled = false;
+  lastHeatmapUpdate = 0;
+  eventDelivery = OFX_WEBCAM_EVENTS_NONE;
+  matchTime = 0;
+  hostReach = 0;
+  threadRunning = false;
+  lastFrameNumber = 0;
+  lastCaptureTime = 0;
+  captureAdvanced = true;
+  frameTime = 0;
+  segmenter = NULL;
+  segmenterKey = -1;
+  pipelineVariant = OFX_WEBCAM_PIPELINE_AUTO;
+  segmentTime = 0;
+  lastBackgroundGrab = 0;
+  webcam = make_shared<ofxWebcamArray>();
 }
 
 ofxWebcamTracker::~ofxWebcamTracker(){
-  webcam.close();
+  stopThread();
+  close();
 }
 
 int ofxWebcamTracker::numWebcamsDetected()
 {
-  return webcam.numWebcamsDetected();
+  return webcam->numWebcamsDetected();
 }
 
 vector<ofVideoDevice> ofxWebcamTracker::getDevices() {
-  return webcam.getDevices();
+  return webcam->getDevices();
 }
 
 void ofxWebcamTracker::init(vector<ofVideoDevice> active, int resolutionWidth, int resolutionHeight){
-  if(numWebcamsDetected() > 0)
+  if(webcam->isInitialized())
   {
-    webcam.init(active, resolutionWidth, resolutionHeight);
-
-    width = webcam.width;
-    height = webcam.height;
-
-    colorImg.allocate(width,height);
-    grayscale.allocate(width, height);
-    background.allocate(width, height);
-    diff.allocate(width, height);
-    threshold = 3;  //60
-    blurAmount = 9;
-    backgroundSubtract = false;
-    blur = false;
-    initialized = true;
-    tolerance = 100;
-    removeAfterSeconds = 5;
-    idCounter = 0;
-    minBlobSize = 100;
-    outdoorMode=false;
-    outdoorModeMinSpeed = 1;
-    outdoorModeBgRefreshRate = 5;
+    setup();
+  }
+  else if(numWebcamsDetected() > 0)
+  {
+    webcam->init(active, resolutionWidth, resolutionHeight);
+    setup();
   }
 }
 
@@ -51,6 +80,54 @@ void ofxWebcamTracker::init(int resolutionWidth, int resolutionHeight){
   init(active, resolutionWidth, resolutionHeight);
 }
 
+//Tracks the frames of an array that other trackers may be reading too.
+//The array is initialized with the default resolution if nobody did yet.
+void ofxWebcamTracker::init(shared_ptr<ofxWebcamArray> shared){
+  stopThread();
+  webcam = shared;
+  init();
+}
+
+shared_ptr<ofxWebcamArray> ofxWebcamTracker::getWebcamArray(){
+  return webcam;
+}
+
+void ofxWebcamTracker::setup(){
+  width = webcam->width;
+  height = webcam->height;
+
+#ifdef OFX_WEBCAM_TRACKER_HEADLESS
+  colorImg.setUseTexture(false);
+  grayscale.setUseTexture(false);
+  background.setUseTexture(false);
+  diff.setUseTexture(false);
+  scaled.setUseTexture(false);
+#endif
+  colorImg.allocate(width,height);
+  grayscale.allocate(width, height);
+  background.allocate(width, height);
+  diff.allocate(width, height);
+  scaled.allocate(width/2, height/2);
+  mask.allocate(width, height);
+  heatmap.setup(width, height, heatmap.getCellSize());
+  zones.setup(width, height, zones.getCellSize());
+  adaptiveDirty = true;
+  threshold = 3;  //60
+  blurAmount = 9;
+  backgroundSubtract = false;
+  blur = false;
+  initialized = true;
+  tolerance = 100;
+  removeAfterSeconds = 5;
+  idCounter = 0;
+  minBlobSize = 100;
+  outdoorMode=false;
+  outdoorModeMinSpeed = 30;
+  outdoorModeBgRefreshRate = 5;
+  contourScale = 1.0;
+  frameNumber = 0;
+}
+
 //Getters and setters
 void ofxWebcamTracker::setBackgroundSubtract(bool value){
   backgroundSubtract = value;
@@ -102,6 +179,7 @@ void ofxWebcamTracker::setOutdoorMode(bool value){
   outdoorMode = value;
 }
 
+//Pixels per second a blob has to move to keep outdoor mode from taking a new background.
 void ofxWebcamTracker::setOutdoorModeMinSpeed(float value) {
   outdoorModeMinSpeed = value;
 }
@@ -111,6 +189,26 @@ void ofxWebcamTracker::setOutdoorModeBgRefreshRate(float value){
   outdoorModeBgRefreshRate= value;
 }
 
+void ofxWebcamTracker::setMaxBlobs(int value){
+  maxBlobs = MAX(1, value);
+}
+
+void ofxWebcamTracker::setLatencyTarget(float millis){
+  governor.setTarget(millis);
+}
+
+void ofxWebcamTracker::setMorphology(ofxWebcamMorphology mode){
+  morphology = mode;
+}
+
+void ofxWebcamTracker::setMorphologyRadius(int value){
+  morphologyRadius = MAX(1, value);
+}
+
+void ofxWebcamTracker::setPackedMask(bool value){
+  packedMask = value;
+  diffStale = usesPackedMask();
+}
 
 bool ofxWebcamTracker::getBackgroundSubtract(){
   return backgroundSubtract;
@@ -177,6 +275,253 @@ float ofxWebcamTracker::getOutdoorModeBgRefreshRate(){
   return outdoorModeBgRefreshRate;
 }
 
+int ofxWebcamTracker::getMaxBlobs(){
+  return maxBlobs;
+}
+
+float ofxWebcamTracker::getLatencyTarget(){
+  return governor.getTarget();
+}
+
+float ofxWebcamTracker::getFrameTime(){
+  return governor.getLastTime();
+}
+
+//Capture time of the frame the blobs come from, in ofGetElapsedTimef() seconds.
+float ofxWebcamTracker::getCaptureTime(){
+  return frameTime;
+}
+
+//Known delay between exposure and the image reaching the grabber, taken
+//off every capture time. Shared by all trackers on the same cameras.
+void ofxWebcamTracker::setCaptureOffset(float millis){
+  webcam->setCaptureOffset(millis);
+}
+
+//Milliseconds from capture to the blobs of that frame being ready. Add
+//your own measurements from ofxWebcamBlob::getCaptureTime() to include output.
+ofxWebcamLatencyHistogram & ofxWebcamTracker::getLatency(){
+  return latency;
+}
+
+int ofxWebcamTracker::getQualityLevel(){
+  return governor.getLevel();
+}
+
+string ofxWebcamTracker::getQualityLevelName(){
+  return governor.getLevelName();
+}
+
+ofxWebcamMorphology ofxWebcamTracker::getMorphology(){
+  return morphology;
+}
+
+int ofxWebcamTracker::getMorphologyRadius(){
+  return morphologyRadius;
+}
+
+float ofxWebcamTracker::getMorphologyTime(){
+  return morphologyTime;
+}
+
+float ofxWebcamTracker::getContourTime(){
+  return contourTime;
+}
+
+//Milliseconds from the blur to the detections in the last segmented frame,
+//all stages together.
+float ofxWebcamTracker::getSegmentTime(){
+  return segmentTime;
+}
+
+//OFX_WEBCAM_PIPELINE_AUTO runs the instance compiled for the settings.
+//OFX_WEBCAM_PIPELINE_GENERIC runs the stages with every setting checked as
+//they go, which is slower and only there to check the instances against.
+//A key from 0 to OFX_WEBCAM_PIPELINE_VARIANTS - 1 forces that instance; its
+//stages have to agree with the settings, in particular the packed mask.
+void ofxWebcamTracker::setPipelineVariant(int variant){
+  std::lock_guard<std::mutex> guard(processMutex);
+  pipelineVariant = MIN(MAX(variant, (int)OFX_WEBCAM_PIPELINE_GENERIC), (int)OFX_WEBCAM_PIPELINE_VARIANTS - 1);
+}
+
+int ofxWebcamTracker::getPipelineVariant(){
+  return pipelineVariant;
+}
+
+//Key of the instance the last frame was segmented with, or
+//OFX_WEBCAM_PIPELINE_GENERIC.
+int ofxWebcamTracker::getPipelineKey(){
+  return segmenterKey;
+}
+
+bool ofxWebcamTracker::getPackedMask(){
+  return packedMask;
+}
+
+//Centroid, bounding box and area always come with a blob. Contours and
+//hulls are only computed and kept when asked for here, as a combination of
+//ofxWebcamBlobAttribute flags. Without contours the background subtracted
+//path labels the packed mask instead of running the contour finder.
+void ofxWebcamTracker::setBlobAttributes(int flags){
+  blobAttributes = flags;
+  diffStale = usesPackedMask();
+}
+
+int ofxWebcamTracker::getBlobAttributes(){
+  return blobAttributes;
+}
+
+//Gives every camera, or every tile of a camera, its own threshold that
+//follows the noise of its part of the difference image. The global
+//threshold becomes the lowest any of them may go.
+void ofxWebcamTracker::setAdaptiveThreshold(bool value){
+  adaptiveThreshold = value;
+  adaptiveDirty = true;
+}
+
+void ofxWebcamTracker::setAdaptiveTiles(int columns, int rows){
+  adaptiveTilesX = MAX(1, columns);
+  adaptiveTilesY = MAX(1, rows);
+  adaptiveDirty = true;
+}
+
+//Multiple of the estimated noise used as the threshold of each region.
+void ofxWebcamTracker::setAdaptiveGain(float value){
+  adaptive.setGain(value);
+}
+
+bool ofxWebcamTracker::getAdaptiveThreshold(){
+  return adaptiveThreshold;
+}
+
+float ofxWebcamTracker::getAdaptiveGain(){
+  return adaptive.getGain();
+}
+
+vector<ofRectangle> & ofxWebcamTracker::getAdaptiveRegions(){
+  return adaptive.getRegions();
+}
+
+vector<float> & ofxWebcamTracker::getAdaptiveThresholds(){
+  return adaptive.getThresholds();
+}
+
+void ofxWebcamTracker::setShadowSuppression(bool value){
+  shadowSuppression = value;
+  if(shadowSuppression && webcam->getLumaIngest())
+  {
+    ofLogWarning("ofxWebcamTracker::setShadowSuppression") << "Shadow suppression needs color frames and does nothing with luma ingest";
+  }
+}
+
+//Brightness of a shadow relative to the background.
+void ofxWebcamTracker::setShadowBrightnessRange(float low, float high){
+  shadowFilter.setBrightnessRange(low, high);
+}
+
+void ofxWebcamTracker::setShadowChromaTolerance(float value){
+  shadowFilter.setChromaTolerance(value);
+}
+
+bool ofxWebcamTracker::getShadowSuppression(){
+  return shadowSuppression;
+}
+
+//Milliseconds spent removing shadows in the last frame, to weigh against
+//getMorphologyTime() and getContourTime().
+float ofxWebcamTracker::getShadowTime(){
+  return shadowTime;
+}
+
+size_t ofxWebcamTracker::getShadowPixels(){
+  return shadowPixels;
+}
+
+//Measures each blob's motion with sparse optical flow inside its bounding
+//box. Velocities and the position expected when matching then come from the
+//flow instead of centroid steps.
+void ofxWebcamTracker::setOpticalFlow(bool value){
+  opticalFlow = value;
+}
+
+bool ofxWebcamTracker::getOpticalFlow(){
+  return opticalFlow;
+}
+
+float ofxWebcamTracker::getFlowTime(){
+  return flowTime;
+}
+
+//Keeps a color histogram of every blob. Removed blobs wait in a gallery
+//for reidentificationTime seconds, and a new blob that looks like one of
+//them, or like a lost blob anywhere in the image, takes its id back.
+//Needs color frames, so it does nothing with luma ingest.
+void ofxWebcamTracker::setReidentification(bool value){
+  if(value && webcam->getLumaIngest())
+  {
+    ofLogWarning("ofxWebcamTracker::setReidentification") << "Reidentification needs color frames and does nothing with luma ingest";
+  }
+  reidentification = value;
+}
+
+void ofxWebcamTracker::setReidentificationTime(float seconds){
+  reidentificationTime = MAX(0, seconds);
+}
+
+//Largest appearance distance (0 to 1) still taken as the same person.
+void ofxWebcamTracker::setReidentificationDistance(float value){
+  reidentificationDistance = ofClamp(value, 0, 1);
+}
+
+void ofxWebcamTracker::setGallerySize(int tracks){
+  gallery.setCapacity(tracks);
+}
+
+bool ofxWebcamTracker::getReidentification(){
+  return reidentification;
+}
+
+float ofxWebcamTracker::getReidentificationTime(){
+  return reidentificationTime;
+}
+
+float ofxWebcamTracker::getReidentificationDistance(){
+  return reidentificationDistance;
+}
+
+ofxWebcamGallery & ofxWebcamTracker::getGallery(){
+  return gallery;
+}
+
+bool ofxWebcamTracker::usesPackedMask(){
+  return packedMask || !(blobAttributes & OFX_WEBCAM_BLOB_CONTOUR);
+}
+
+void ofxWebcamTracker::copyAttributes(ofxWebcamBlob & blob, int detection){
+  if((blobAttributes & OFX_WEBCAM_BLOB_HULL) && detection < (int)detectedHulls.size())
+  {
+    blob.setHull(detectedHulls[detection]);
+  }
+}
+
+//Number of foreground pixels in the last thresholded mask. Only reads, so
+//between lock() and unlock() it is safe while the worker thread runs.
+size_t ofxWebcamTracker::getForegroundArea(){
+  if(usesPackedMask())
+  {
+    return mask.count();
+  }
+  const ofPixels & pix = diff.getPixels();
+  const unsigned char * p = pix.getData();
+  size_t n = pix.size();
+  size_t area = 0;
+  for(size_t i=0; i<n; i++)
+  {
+    area += p[i] != 0;
+  }
+  return area;
+}
+
 vector<ofxWebcamBlob> ofxWebcamTracker::getActiveBlobs(){
   vector<ofxWebcamBlob> vec;
 
@@ -205,7 +550,7 @@ bool ofxWebcamTracker::shouldGrabBackground(){
 
   if (numBlobs == 0)
   {
-    return (ofGetElapsedTimef() - lastBackgroundGrab) > outdoorModeBgRefreshRate;
+    return (frameTime - lastBackgroundGrab) > outdoorModeBgRefreshRate;
   }
 
   for(uint8_t i=0; i<numBlobs; i++)
@@ -218,419 +563,1234 @@ bool ofxWebcamTracker::shouldGrabBackground(){
       }
     }
     else {
-      float bls = blobs[i].timeSinceLastSeen();
+      float bls = blobs[i].timeSinceLastSeen(frameTime);
       if(lastSeen == -1 || lastSeen < bls){
         lastSeen = bls;
       }
     }
   }
   
-  return active == 0 && lastSeen > 3 && (ofGetElapsedTimef() - lastBackgroundGrab) > outdoorModeBgRefreshRate;
+  return active == 0 && lastSeen > 3 && (frameTime - lastBackgroundGrab) > outdoorModeBgRefreshRate;
 }
 
 void ofxWebcamTracker::update(){
-  if(numWebcamsDetected() > 0)
+  if(webcam->isInitialized())
   {
-    webcam.update();
-    colorImg.setFromPixels(webcam.getPixels());
-    grayscale = colorImg;
-
-    if(blur)
+    //The cameras are always updated from the calling (main) thread.
+    //Each frame is processed once, however often update() is called.
+    ofxWebcamFrame frame = webcam->grab();
+    if(!threadRunning && frame.number > 0 && frame.number != lastFrameNumber)
     {
-      grayscale.blurGaussian(blurAmount);
+      process(frame);
     }
+  }
+}
 
-    if(backgroundSubtract){
-      subtractBackground();
-      contourFinder.findContours(diff, minBlobSize, (width*height)/2, 20, false);
-    }
-    else {
-      contourFinder.findContours(grayscale, minBlobSize, (width*height)/2, 20, false);
-    }
+void ofxWebcamTracker::process(ofxWebcamFrame & frame){
+  std::lock_guard<std::mutex> guard(processMutex);
+  uint64_t frameStart = ofGetElapsedTimeMicros();
+  lastFrameNumber = frame.number;
+  frameTime = frame.captureTime > 0 ? frame.captureTime / 1000000.0 : ofGetElapsedTimef();
+  //A camera that did not deliver holds the capture time back; such a frame
+  //says nothing about how fast blobs move or how late the frames are.
+  captureAdvanced = frame.captureTime == 0 || frame.captureTime != lastCaptureTime;
+  lastCaptureTime = frame.captureTime;
+
+  //The color image is only filled in when something shows it.
+  if(frame.luma)
+  {
+    grayscale.setFromPixels(*frame.luma);
+    colorFrame.reset();
+  }
+  else
+  {
+    ofxWebcamLuma::extract(*frame.pixels, lumaPixels);
+    grayscale.setFromPixels(lumaPixels);
+    colorFrame = frame.pixels;
+  }
+  colorStale = true;
+
+  if(governor.shouldSegment(frameNumber))
+  {
+    selectPipeline();
+    uint64_t segmentStart = ofGetElapsedTimeMicros();
+    (this->*segmenter)();
+    segmentTime = (ofGetElapsedTimeMicros() - segmentStart) / 1000.0f;
 
     matchAndUpdateBlobs();
+    updateHeatmap();
 
     if(outdoorMode && shouldGrabBackground())
     {
       grabBackground();
     }
   }
-}
-
-void ofxWebcamTracker::grabBackground() {
-  background.setFromPixels(grayscale.getPixels());
-  backgroundSubtract = true;
-  clearBlobs();
-  lastBackgroundGrab = ofGetElapsedTimef();
-}
-
-void ofxWebcamTracker::subtractBackground() {
+  else if(captureAdvanced)
+  {
+    extrapolateBlobs();
+  }
 
-  ofPixels & pix = grayscale.getPixels();
-	ofPixels & bgPix = background.getPixels();
-	ofPixels & d = diff.getPixels();
+  updateZones();
+  dispatchEvents();
 
-  //TODO: Better to do the threshold in the source image
-  //like it is done in https://github.com/openframeworks/openFrameworks/blob/master/examples/computer_vision/webcamExample/src/ofApp.cpp
+  snapshots.publish(frame.number, frameTime, blobs);
 
-	int numPixels = pix.size();
-	for(int i = 0; i < numPixels; i++) {
-		if(abs(pix[i] - bgPix[i]) < threshold) {
-			d[i] = 0;
-		}
-		else
-		{
-			d[i] = 255;
-		}
-	}
+  if(logWriter.isOpen())
+  {
+    logWriter.addFrame(frame.number, frame.captureTime > 0 ? frame.captureTime : ofGetElapsedTimeMicros(), blobs);
+  }
 
-  diff.flagImageChanged();
+  frameNumber++;
+  uint64_t frameEnd = ofGetElapsedTimeMicros();
+  governor.update((frameEnd - frameStart) / 1000.0f);
+  if(!frame.simulated && captureAdvanced && frame.captureTime > 0 && frameEnd > frame.captureTime)
+  {
+    latency.add((frameEnd - frame.captureTime) / 1000.0f);
+  }
 }
 
-//The Tracker
-void ofxWebcamTracker::matchAndUpdateBlobs()
+void ofxWebcamTracker::findBlobs(ofxCvGrayscaleImage & image)
 {
-  if(numWebcamsDetected() > 0)
+  uint64_t start = ofGetElapsedTimeMicros();
+  int candidates = governor.getMaxCandidates(maxBlobs);
+  contourScale = governor.getProcessingScale();
+
+  if(contourScale < 1.0)
   {
-    vector<ofxCvBlob> cvBlobs = contourFinder.blobs;
-    vector<bool> trackedBlob(blobs.size(), false);
-    vector<ofxCvBlob>::iterator currentBlob = cvBlobs.begin();
-    vector<ofxCvBlob> newBlobs;
+    scaled.scaleIntoMe(image, CV_INTER_NN);
+    float areaScale = contourScale * contourScale;
+    contourFinder.findContours(scaled, minBlobSize*areaScale, (width*height*areaScale)/2, candidates, false);
 
-    while(currentBlob != cvBlobs.end())
+    //Bring the blobs back to full resolution so matching does not care about the scale.
+    float s = 1.0 / contourScale;
+    for(size_t i=0; i<contourFinder.blobs.size(); i++)
     {
-      int chosenMatch = -1;
-      float minDifference = 10000; //TODO: this should be flagged instead of ridiculous value.
-
-      for(uint8_t i=0; i<blobs.size(); i++)
-      {
-        float blobDiff = blobs[i].difference(*currentBlob);
-
-        if(blobDiff == 0)
-        {
-          chosenMatch = i;
-          break;
-        }
-
-        if(blobDiff != -1 && blobDiff <= minDifference)
-        {
-          if(blobDiff == minDifference)
-          {
-            //TODO: There are two blobs that match, this is really rare. How to decide which blob is which?
-            //      right now the latest blob in the vector will be chosen.
-            ofLog(OF_LOG_WARNING) << "Blob conflict found!!" << endl;
-          }
-          minDifference = blobDiff;
-          chosenMatch = i;
-        }
-      }
-
-      if(chosenMatch != -1)
-      {
-        blobs[chosenMatch].update(*currentBlob);
-        trackedBlob[chosenMatch] = true;
-      }
-      else
+      ofxCvBlob & b = contourFinder.blobs[i];
+      b.area *= s*s;
+      b.length *= s;
+      b.centroid *= s;
+      b.boundingRect.x *= s;
+      b.boundingRect.y *= s;
+      b.boundingRect.width *= s;
+      b.boundingRect.height *= s;
+      for(size_t p=0; p<b.pts.size(); p++)
       {
-        bool isValid = true;
-        // for(uint8_t i=0; i<blobs.size(); i++)
-        // {
-        //   float interArea = currentBlob->boundingRect.getIntersection(blobs[i].blob.boundingRect).getArea();
-        //   if(interArea != 0 && (interArea >= currentBlob->boundingRect.getArea() * 0.9 || interArea >= blobs[i].blob.boundingRect.getArea() * 0.7))
-        //   {
-        //     isValid = false;
-        //   }
-        // }
-
-        if(isValid) newBlobs.push_back(*currentBlob);
+        b.pts[p] *= s;
       }
-
-      currentBlob++;
-    }
-
-    for(uint8_t i=0; i<newBlobs.size(); i++)
-    {
-      ofxWebcamBlob newBlob(++idCounter, newBlobs[i], tolerance);
-      blobs.push_back(newBlob);
-    }
-
-    for(uint8_t i=0; i<trackedBlob.size(); i++)
-    {
-        if(!trackedBlob[i])
-        {
-          if(!blobs[i].isOverlapping() && blobs[i].timeSinceLastSeen() > removeAfterSeconds)
-          {
-              if(i < blobs.size()){
-                  blobs.erase(blobs.begin()+i);
-              }
-          }
-
-          //If blob just disapeared or is overlapping
-          if((blobs[i].isActive() && isOverlapCandidate(blobs[i])) || blobs[i].isOverlapping())
-          {
-            int overlapIndex = -1;
-            for(uint8_t b=0; b<blobs.size(); b++)
-            {
-              if(trackedBlob[b] && isOverlapCandidate(blobs[b]) && blobs[i].intersects(blobs[b]))
-              {
-                //BLOBS OVERLAP!
-                blobs[i].setOverlap(true);
-                blobs[b].setOverlap(true);
-                overlapIndex = b;
-                break;
-              }
-            }
-
-            if(overlapIndex == -1)
-            {
-              for(uint8_t b=0; b<blobs.size(); b++)
-              {
-                blobs[b].setOverlap(false);
-              }
-            }
-          }
-        }
-        else {
-          if(!blobs[i].isActive())
-          {
-            //Blob came back!
-            for(uint8_t b=0; b<blobs.size(); b++)
-            {
-              blobs[b].setOverlap(false);
-            }
-          }
-
-          if(blobs[i].isOverlapping())
-          {
-            for(uint8_t b=0; b<blobs.size(); b++)
-            {
-              if(trackedBlob[b] && blobs[b].isOverlapping() && !blobs[i].intersects(blobs[b]))
-              {
-                //BLOBS STOPPED OVERLAPPING!
-                blobs[i].setOverlap(false);
-                blobs[b].setOverlap(false);
-                break;
-              }
-            }
-          }
-        }
-        blobs[i].setActive(trackedBlob[i]);
     }
   }
-}
+  else
+  {
+    contourFinder.findContours(image, minBlobSize, (width*height)/2, candidates, false);
+  }
 
-bool ofxWebcamTracker::thereAreOverlaps()
-{
-  for(uint8_t b=0; b<blobs.size(); b++)
+  detected = contourFinder.blobs;
+  if(blobAttributes & OFX_WEBCAM_BLOB_HULL)
   {
-    if(blobs[b].isOverlapping())
+    detectedHulls.resize(detected.size());
+    for(size_t i=0; i<detected.size(); i++)
     {
-      return true;
+      hullPoints = detected[i].pts;
+      ofxWebcamRunLabeller::convexHull(hullPoints, detectedHulls[i]);
     }
   }
-  return false;
-}
-
-ofxWebcamBlob * ofxWebcamTracker::getOverlapBlob()
-{
-  for(uint8_t b=0; b<blobs.size(); b++)
+  if(!(blobAttributes & OFX_WEBCAM_BLOB_CONTOUR))
   {
-    if(blobs[b].isOverlapping() && blobs[b].isActive())
+    //Nobody asked for the outline, so do not copy it around.
+    for(size_t i=0; i<detected.size(); i++)
     {
-      return &blobs[b];
+      detected[i].pts.clear();
+      detected[i].nPts = 0;
     }
   }
-  return NULL;
-}
-
-void ofxWebcamTracker::clearBlobs(){
-  blobs.clear();
-}
-
-
-//Image Getters
-ofxCvColorImage ofxWebcamTracker::getColorImage(){
-  return colorImg;
+  contourTime = (ofGetElapsedTimeMicros() - start) / 1000.0f;
 }
 
-ofxCvGrayscaleImage ofxWebcamTracker::getGrayImage(){
-  return grayscale;
+//Labels the packed mask straight from its runs. The labeller is cheap at
+//full resolution, so the governor's processing scale does not apply here.
+void ofxWebcamTracker::labelBlobs()
+{
+  uint64_t start = ofGetElapsedTimeMicros();
+  contourScale = 1.0;
+  bool hulls = blobAttributes & OFX_WEBCAM_BLOB_HULL;
+  labeller.findBlobs(mask, minBlobSize, (width*height)/2, governor.getMaxCandidates(maxBlobs), detected, hulls ? &detectedHulls : NULL);
+  contourTime = (ofGetElapsedTimeMicros() - start) / 1000.0f;
 }
 
-//Draw and debug methods
-void ofxWebcamTracker::drawRGB(float x, float y)
+void ofxWebcamTracker::expandDiff()
 {
-  if(numWebcamsDetected() > 0){
-    ofSetColor(255);
-    colorImg.draw(x, y, width, height);
+  if(usesPackedMask() && diffStale)
+  {
+    mask.toPixels(diff.getPixels());
+    diff.flagImageChanged();
+    diffStale = false;
   }
 }
 
-void ofxWebcamTracker::drawRGB(float x, float y, float scale)
+//With luma ingest there is no color frame and the cameras are stitched again.
+void ofxWebcamTracker::expandColor()
 {
-  if(numWebcamsDetected() > 0){
-    ofSetColor(255);
-    colorImg.draw(x, y, width*scale, height*scale);
+  if(colorStale)
+  {
+    colorImg.setFromPixels(colorFrame ? *colorFrame : webcam->getPixels());
+    colorStale = false;
   }
 }
 
-void ofxWebcamTracker::drawGrayscale(float x, float y)
+void ofxWebcamTracker::extrapolateBlobs()
 {
-  if(numWebcamsDetected() > 0){
-    ofSetColor(255);
-    grayscale.draw(x, y, width, height);
+  for(size_t i=0; i<blobs.size(); i++)
+  {
+    if(blobs[i].isActive())
+    {
+      blobs[i].extrapolate(frameTime);
+    }
   }
 }
 
-void ofxWebcamTracker::drawGrayscale(float x, float y, float scale)
-{
-  if(numWebcamsDetected() > 0){
-    ofSetColor(255);
-    grayscale.draw(x, y, width*scale, height*scale);
+void ofxWebcamTracker::grabBackground() {
+  background.setFromPixels(grayscale.getPixels());
+  if(colorFrame)
+  {
+    shadowFilter.setBackground(*colorFrame);
+  }
+  else
+  {
+    shadowFilter.clear();
   }
+  backgroundSubtract = true;
+  clearBlobs();
+  lastBackgroundGrab = frameTime;
 }
 
-void ofxWebcamTracker::drawBlobPositions(float x, float y)
+//Drops foreground pixels that are only darker (or, with a range above 1,
+//brighter) versions of the background's color. Needs the RGB frame, so it
+//does nothing with luma ingest.
+//The Tracker
+static bool sortByCost(const ofxWebcamMatch & a, const ofxWebcamMatch & b)
 {
-  if(numWebcamsDetected() > 0){
-    drawBlobPositions(x,y,1.0);
-  }
+  return a.cost < b.cost;
 }
 
-void ofxWebcamTracker::drawBlobPositions(float x, float y, float scale)
+void ofxWebcamTracker::matchAndUpdateBlobs()
 {
-  if(numWebcamsDetected() > 0){
-    for (uint8_t i = 0; i < blobs.size(); i++)
+  if(webcam->isInitialized())
+  {
+    estimateFlow();
+
+    uint64_t start = ofGetElapsedTimeMicros();
+    int numDetections = detected.size();
+    int numBlobs = blobs.size();
+
+    detectionOwner.assign(numDetections, -1);
+    trackedBlob.assign(numBlobs, false);
+    buildIdLookup();
+
+    //Candidate pairs come from the grid, so each detection is only compared
+    //with the blobs around it.
+    indexPoints.clear();
+    for(int b=0; b<numBlobs; b++)
+    {
+      indexPoints.push_back(blobs[b].blob.centroid);
+    }
+    blobIndex.build(indexPoints, tolerance, width, height);
+
+    matches.clear();
+    for(int d=0; d<numDetections; d++)
     {
-      if(blobs[i].isActive())
+      blobIndex.query(detected[d].centroid, tolerance, neighbours);
+      for(size_t n=0; n<neighbours.size(); n++)
       {
-        ofFill();
-        ofSetColor(255,0,0);
-        ofDrawCircle(x+ blobs[i].blob.centroid.x * scale,
-          y+ blobs[i].blob.centroid.y * scale,
-          10);
-
-        ofSetColor(255);
-        ofDrawBitmapString(ofToString(blobs[i].id),
-        x+ blobs[i].blob.centroid.x * scale,
-        y+ blobs[i].blob.centroid.y * scale);
-
-        if(blobs[i].isOverlapping())
+        int b = neighbours[n];
+        //Merged blobs only come back through a split.
+        if(blobs[b].isMerged()) continue;
+
+        float cost = blobs[b].difference(detected[d]);
+        if(cost >= 0)
         {
-          ofSetLineWidth(10);
-          ofNoFill();
-          ofSetColor(255,0,0);
-          ofDrawRectangle(x+blobs[i].blob.boundingRect.x * scale,
-            y+blobs[i].blob.boundingRect.y * scale,
-            blobs[i].blob.boundingRect.width * scale,
-            blobs[i].blob.boundingRect.height * scale);
-          ofSetLineWidth(1);
+          ofxWebcamMatch m = {cost, d, b};
+          matches.push_back(m);
         }
       }
-      else {
-        ofNoFill();
-        ofDrawCircle(x+ blobs[i].blob.centroid.x * scale,
-          y+ blobs[i].blob.centroid.y * scale,
-          10);
-
-        ofSetColor(255);
-        ofDrawBitmapString(ofToString(blobs[i].id),
-        x+ blobs[i].blob.centroid.x * scale,
-        y+ blobs[i].blob.centroid.y * scale);
+    }
+
+    //Cheapest pairs first, every blob and detection is used at most once.
+    std::sort(matches.begin(), matches.end(), sortByCost);
+    for(size_t m=0; m<matches.size(); m++)
+    {
+      if(detectionOwner[matches[m].detection] == -1 && !trackedBlob[matches[m].blob])
+      {
+        detectionOwner[matches[m].detection] = matches[m].blob;
+        trackedBlob[matches[m].blob] = true;
+      }
+    }
+
+    for(int d=0; d<numDetections; d++)
+    {
+      int b = detectionOwner[d];
+      if(b == -1) continue;
+
+      bool wasActive = blobs[b].isActive();
+      blobs[b].update(detected[d], frameTime);
+      copyAttributes(blobs[b], d);
+      updateAppearance(blobs[b], d);
+      recordTrajectory(blobs[b]);
+      if(!wasActive || (captureAdvanced && blobs[b].speed > 0))
+      {
+        emitBlobEvent(OFX_WEBCAM_BLOB_MOVED, blobs[b]);
+      }
+    }
+
+    followHosts();
+    findMerges();
+    indexHosts();
+
+    for(int d=0; d<numDetections; d++)
+    {
+      if(detectionOwner[d] == -1 && !findSplit(d) && !reidentify(d))
+      {
+        ofxWebcamBlob newBlob(++idCounter, detected[d], tolerance, frameTime);
+        copyAttributes(newBlob, d);
+        newBlob.appearance = detectionAppearance;
+        newBlob.setTrajectory(trajectories.acquire());
+        recordTrajectory(newBlob);
+        emitBlobEvent(OFX_WEBCAM_BLOB_ENTERED, newBlob);
+        blobs.push_back(newBlob);
+      }
+    }
+
+    for(int b=0; b<numBlobs; b++)
+    {
+      bool seen = trackedBlob[b];
+      if(!seen && blobs[b].isMerged())
+      {
+        //Carried along while the blob it merged into is being tracked.
+        int host = findBlobIndex(blobs[b].getMergedInto());
+        seen = host != -1 && host < numBlobs && trackedBlob[host];
+      }
+
+      if(!seen && blobs[b].isActive())
+      {
+        emitBlobEvent(OFX_WEBCAM_BLOB_LOST, blobs[b]);
       }
+      blobs[b].setActive(seen, frameTime);
     }
+
+    removeExpiredBlobs();
+    rememberFlow();
+    matchTime = (ofGetElapsedTimeMicros() - start) / 1000.0f;
   }
 }
 
-void ofxWebcamTracker::drawBackground(float x, float y)
+//Flow from the last segmented frame to this one, for the blobs that were
+//active in both.
+void ofxWebcamTracker::estimateFlow()
 {
-  if(numWebcamsDetected() > 0 && backgroundSubtract){
-    ofSetColor(255);
-    background.draw(x,y);
+  if(!opticalFlow)
+  {
+    for(size_t b=0; b<blobs.size(); b++) blobs[b].clearFlow();
+    flowTime = 0;
+    return;
   }
-}
 
-void ofxWebcamTracker::drawBackground(float x, float y, float scale)
+  uint64_t start = ofGetElapsedTimeMicros();
+  ofPixels & pix = grayscale.getPixels();
+  if(flow.getWidth() != (int)pix.getWidth() || flow.getHeight() != (int)pix.getHeight())
+  {
+    flow.setup(pix.getWidth(), pix.getHeight());
+  }
+
+  ofVec2f step;
+  for(size_t b=0; b<blobs.size(); b++)
+  {
+    if(blobs[b].isActive() && flow.track(pix, blobs[b].blob.boundingRect, step))
+    {
+      blobs[b].setFlow(step);
+    }
+    else
+    {
+      blobs[b].clearFlow();
+    }
+  }
+  flowTime = (ofGetElapsedTimeMicros() - start) / 1000.0f;
+}
+
+//Keeps the pixels around where the active blobs are now for the next frame.
+void ofxWebcamTracker::rememberFlow()
+{
+  if(!opticalFlow) return;
+
+  uint64_t start = ofGetElapsedTimeMicros();
+  ofPixels & pix = grayscale.getPixels();
+  for(size_t b=0; b<blobs.size(); b++)
+  {
+    if(blobs[b].isActive())
+    {
+      flow.remember(pix, blobs[b].blob.boundingRect);
+    }
+  }
+  flow.nextFrame();
+  flowTime += (ofGetElapsedTimeMicros() - start) / 1000.0f;
+}
+
+//Members of a merge keep their offset to the blob they are inside.
+void ofxWebcamTracker::followHosts()
+{
+  for(size_t b=0; b<blobs.size(); b++)
+  {
+    if(!blobs[b].isMerged()) continue;
+
+    int host = findBlobIndex(blobs[b].getMergedInto());
+    if(host != -1 && host < (int)trackedBlob.size() && trackedBlob[host])
+    {
+      blobs[b].follow(blobs[host]);
+    }
+  }
+}
+
+//A blob that vanished away from the image edges while overlapping a tracked
+//blob is assumed to be inside it, rather than gone.
+void ofxWebcamTracker::findMerges()
+{
+  indexPoints.clear();
+  float reach = 0;
+  for(size_t d=0; d<detected.size(); d++)
+  {
+    indexPoints.push_back(detected[d].centroid);
+    const ofRectangle & r = detected[d].boundingRect;
+    reach = MAX(reach, sqrt(r.width*r.width + r.height*r.height) / 2);
+  }
+  detectionIndex.build(indexPoints, tolerance, width, height);
+
+  for(size_t b=0; b<trackedBlob.size(); b++)
+  {
+    if(trackedBlob[b] || !blobs[b].isActive() || blobs[b].isMerged() || !isOverlapCandidate(blobs[b])) continue;
+
+    const ofRectangle & rect = blobs[b].blob.boundingRect;
+    float radius = reach + sqrt(rect.width*rect.width + rect.height*rect.height) / 2;
+    detectionIndex.query(blobs[b].blob.centroid, radius, neighbours);
+
+    int host = -1;
+    float bestArea = 0;
+    for(size_t n=0; n<neighbours.size(); n++)
+    {
+      int owner = detectionOwner[neighbours[n]];
+      if(owner == -1 || owner == (int)b) continue;
+
+      float area = rect.getIntersection(detected[neighbours[n]].boundingRect).getArea();
+      if(area > bestArea)
+      {
+        bestArea = area;
+        host = owner;
+      }
+    }
+
+    if(host == -1) continue;
+
+    bool hostWasAlone = blobs[host].getMembers().empty();
+
+    //Anything that was inside this blob is now inside the host too.
+    vector<int> inherited = blobs[b].getMembers();
+    for(size_t m=0; m<inherited.size(); m++)
+    {
+      int member = findBlobIndex(inherited[m]);
+      if(member != -1)
+      {
+        blobs[member].split(blobs[b]);
+        blobs[member].mergeInto(blobs[host]);
+      }
+    }
+
+    blobs[b].mergeInto(blobs[host]);
+    emitBlobEvent(OFX_WEBCAM_BLOB_OVERLAP_BEGAN, blobs[b], blobs[host].id);
+    if(hostWasAlone)
+    {
+      emitBlobEvent(OFX_WEBCAM_BLOB_OVERLAP_BEGAN, blobs[host], blobs[b].id);
+    }
+  }
+}
+
+//When an unclaimed detection appears next to a merge, give it back the id
+//of the member that best fits its predicted position and original area.
+//Blobs that others merged into, in a grid of their own, so a detection
+//looking for the host it split from only checks the ones around it.
+void ofxWebcamTracker::indexHosts()
+{
+  hosts.clear();
+  indexPoints.clear();
+  hostReach = 0;
+  for(size_t h=0; h<trackedBlob.size(); h++)
+  {
+    if(blobs[h].getMembers().empty()) continue;
+    hosts.push_back(h);
+    indexPoints.push_back(blobs[h].blob.centroid);
+    const ofRectangle & r = blobs[h].blob.boundingRect;
+    hostReach = MAX(hostReach, sqrt(r.width*r.width + r.height*r.height));
+  }
+  //The centroid can be anywhere in the box, so reach over its whole diagonal.
+  hostReach += tolerance * sqrt(2.0f);
+  hostIndex.build(indexPoints, tolerance, width, height);
+}
+
+bool ofxWebcamTracker::findSplit(int detection)
+{
+  const ofxCvBlob & d = detected[detection];
+  int best = -1;
+  int bestHost = -1;
+  float bestCost = 0;
+
+  if(hosts.empty())
+  {
+    return false;
+  }
+
+  hostIndex.query(d.centroid, hostReach, nearbyHosts);
+  for(size_t n=0; n<nearbyHosts.size(); n++)
+  {
+    int h = hosts[nearbyHosts[n]];
+    vector<int> & members = blobs[h].getMembers();
+    if(members.empty()) continue;
+
+    ofRectangle reach = blobs[h].blob.boundingRect;
+    reach.x -= tolerance;
+    reach.y -= tolerance;
+    reach.width += tolerance * 2;
+    reach.height += tolerance * 2;
+    if(!reach.inside(d.centroid.x, d.centroid.y)) continue;
+
+    for(size_t m=0; m<members.size(); m++)
+    {
+      int member = findBlobIndex(members[m]);
+      if(member == -1) continue;
+
+      ofxCvBlob & predicted = blobs[member].blob;
+      float distance = predicted.centroid.distance(d.centroid) / MAX(1.0f, tolerance);
+      float areaChange = fabs(predicted.area - d.area) / MAX(1.0f, MAX(predicted.area, d.area));
+      float cost = distance + areaChange;
+      if(best == -1 || cost < bestCost)
+      {
+        best = member;
+        bestHost = h;
+        bestCost = cost;
+      }
+    }
+  }
+
+  if(best == -1)
+  {
+    return false;
+  }
+
+  blobs[best].split(blobs[bestHost]);
+  blobs[best].update(d, frameTime);
+  copyAttributes(blobs[best], detection);
+  recordTrajectory(blobs[best]);
+  detectionOwner[detection] = best;
+  trackedBlob[best] = true;
+
+  emitBlobEvent(OFX_WEBCAM_BLOB_OVERLAP_ENDED, blobs[best], blobs[bestHost].id);
+  if(blobs[bestHost].getMembers().empty())
+  {
+    emitBlobEvent(OFX_WEBCAM_BLOB_OVERLAP_ENDED, blobs[bestHost], blobs[best].id);
+  }
+  return true;
+}
+
+void ofxWebcamTracker::removeExpiredBlobs()
+{
+  //Untie merges first, while every index in the lookup is still valid.
+  bool anyExpired = false;
+  expiredBlob.assign(blobs.size(), false);
+  for(size_t b=0; b<blobs.size(); b++)
+  {
+    ofxWebcamBlob & blob = blobs[b];
+    if(blob.isActive() || blob.timeSinceLastSeen(frameTime) <= removeAfterSeconds) continue;
+    expiredBlob[b] = true;
+    anyExpired = true;
+
+    if(blob.isMerged())
+    {
+      int host = findBlobIndex(blob.getMergedInto());
+      if(host != -1) blob.split(blobs[host]);
+    }
+
+    //Whatever was inside it becomes an ordinary lost blob.
+    vector<int> members = blob.getMembers();
+    for(size_t m=0; m<members.size(); m++)
+    {
+      int member = findBlobIndex(members[m]);
+      if(member != -1) blobs[member].split(blob);
+    }
+
+    //The gallery holds on to the trajectory until the id is taken back.
+    if(reidentification && blob.appearance.valid)
+    {
+      gallery.add(blob.id, frameTime - blob.timeSinceLastSeen(frameTime), blob.getTrajectory(), blob.appearance, releasedTrajectories);
+    }
+    else
+    {
+      trajectories.release(blob.getTrajectory());
+    }
+    emitBlobEvent(OFX_WEBCAM_BLOB_REMOVED, blob);
+  }
+
+  gallery.expire(frameTime, reidentificationTime, releasedTrajectories);
+  releaseTrajectories();
+
+  if(!anyExpired) return;
+
+  size_t kept = 0;
+  for(size_t b=0; b<blobs.size(); b++)
+  {
+    if(!expiredBlob[b])
+    {
+      if(kept != b) blobs[kept] = blobs[b];
+      kept++;
+    }
+  }
+  blobs.erase(blobs.begin() + kept, blobs.end());
+  buildIdLookup();
+}
+
+void ofxWebcamTracker::releaseTrajectories()
 {
-  if(numWebcamsDetected() > 0 && backgroundSubtract){
-    ofSetColor(255);
-    background.draw(x,y,width*scale, height*scale);
+  for(size_t i=0; i<releasedTrajectories.size(); i++)
+  {
+    trajectories.release(releasedTrajectories[i]);
   }
+  releasedTrajectories.clear();
 }
 
-void ofxWebcamTracker::drawContours(float x, float y)
+//Histogram of the detection's foreground pixels, from the packed mask or
+//the 8 bit diff.
+bool ofxWebcamTracker::computeAppearance(int detection, ofxWebcamAppearance & out)
 {
-  if(numWebcamsDetected() > 0){
-    contourFinder.draw(x,y);
+  if(!reidentification || !colorFrame || !backgroundSubtract)
+  {
+    out.clear();
+    return false;
+  }
+
+  const ofRectangle & rect = detected[detection].boundingRect;
+  if(usesPackedMask())
+  {
+    out.compute(*colorFrame, rect, mask);
   }
+  else
+  {
+    out.compute(*colorFrame, rect, diff.getPixels());
+  }
+  return out.valid;
 }
 
-void ofxWebcamTracker::drawContours(float x, float y, float scale)
+//Overlapping blobs share their pixels with others and are left as they were.
+void ofxWebcamTracker::updateAppearance(ofxWebcamBlob & blob, int detection)
 {
-  if(numWebcamsDetected() > 0){
-    contourFinder.draw(x,y,width*scale,height*scale);
+  if(reidentification && !blob.isOverlapping() && computeAppearance(detection, detectionAppearance))
+  {
+    blob.appearance.blend(detectionAppearance);
   }
 }
 
-void ofxWebcamTracker::drawDiff(float x, float y)
+//Gives an unmatched detection the id of the lost blob or removed track it
+//looks most like, wherever that was last seen.
+bool ofxWebcamTracker::reidentify(int detection)
 {
-  if(numWebcamsDetected() > 0 && backgroundSubtract){
-    ofSetColor(255);
-    diff.draw(x, y);
+  if(!computeAppearance(detection, detectionAppearance)) return false;
+
+  int best = -1;
+  float bestDistance = reidentificationDistance;
+  for(size_t b=0; b<trackedBlob.size(); b++)
+  {
+    if(trackedBlob[b] || blobs[b].isActive() || blobs[b].isMerged()) continue;
+    float distance = detectionAppearance.distance(blobs[b].appearance);
+    if(distance < bestDistance)
+    {
+      best = b;
+      bestDistance = distance;
+    }
+  }
+
+  ofxWebcamGallery::Entry entry;
+  if(gallery.take(detectionAppearance, bestDistance, entry))
+  {
+    ofxWebcamBlob returned(entry.id, detected[detection], tolerance, frameTime);
+    copyAttributes(returned, detection);
+    returned.appearance = entry.appearance;
+    returned.appearance.blend(detectionAppearance);
+    returned.setTrajectory(entry.trajectory);
+    recordTrajectory(returned);
+    emitBlobEvent(OFX_WEBCAM_BLOB_ENTERED, returned);
+    blobs.push_back(returned);
+    return true;
   }
+
+  if(best == -1) return false;
+
+  blobs[best].update(detected[detection], frameTime);
+  copyAttributes(blobs[best], detection);
+  blobs[best].appearance.blend(detectionAppearance);
+  recordTrajectory(blobs[best]);
+  detectionOwner[detection] = best;
+  trackedBlob[best] = true;
+  emitBlobEvent(OFX_WEBCAM_BLOB_MOVED, blobs[best]);
+  return true;
 }
 
-void ofxWebcamTracker::drawDiff(float x, float y, float scale)
+void ofxWebcamTracker::buildIdLookup()
 {
-  if(numWebcamsDetected() > 0 && backgroundSubtract){
-    ofSetColor(255);
-    diff.draw(x,y,width*scale,height*scale);
+  idLookup.clear();
+  for(size_t b=0; b<blobs.size(); b++)
+  {
+    idLookup.push_back(std::make_pair(blobs[b].id, (int)b));
   }
+  std::sort(idLookup.begin(), idLookup.end());
 }
 
-void ofxWebcamTracker::drawDebug(float x, float y)
+//Index of the blob with the given id in blobs, as of the last lookup build.
+int ofxWebcamTracker::findBlobIndex(int id)
 {
-  if(numWebcamsDetected() > 0){
-    drawDebug(x, y, 1.0);
+  vector<pair<int, int> >::iterator it = std::lower_bound(idLookup.begin(), idLookup.end(), std::make_pair(id, -1));
+  if(it != idLookup.end() && it->first == id)
+  {
+    return it->second;
   }
+  return -1;
 }
 
+void ofxWebcamTracker::emitBlobEvent(ofxWebcamBlobEventType type, ofxWebcamBlob & blob, int otherId)
+{
+  if(eventDelivery == OFX_WEBCAM_EVENTS_NONE)
+  {
+    return;
+  }
 
-void ofxWebcamTracker::drawDebug(float x, float y, float scale)
+  ofxWebcamBlobEvent event;
+  event.type = type;
+  event.id = blob.id;
+  event.otherId = otherId;
+  event.centroid = blob.blob.centroid;
+  event.boundingRect = blob.blob.boundingRect;
+  event.time = frameTime;
+  event.frame = frameNumber;
+  frameEvents.push_back(event);
+}
+
+//Only blobs that moved are looked at, so a frame that was not segmented
+//costs nothing unless extrapolation moved them.
+void ofxWebcamTracker::updateZones()
 {
-  if(numWebcamsDetected() > 0)
+  zones.update(blobs, frameTime, frameNumber, zoneEvents);
+  if(eventDelivery == OFX_WEBCAM_EVENTS_NONE)
   {
-    drawGrayscale    (x, y, 0.5 * scale);
-    drawBackground   (x+width*scale/2, y, 0.5 * scale);
-    drawDiff         (x, y+height*scale/2, 0.5 * scale);
-    drawRGB          (x+width*scale/2, y+height*scale/2, 0.5 * scale);
-    drawContours     (x+width*scale/2, y+height*scale/2, 0.5 * scale);
-    drawBlobPositions(x+width*scale/2, y+height*scale/2, 0.5 * scale);
-    drawEdgeThreshold(x+width*scale/2, y+height*scale/2, 0.5 * scale);
+    zoneEvents.clear();
   }
 }
 
-void ofxWebcamTracker::drawEdgeThreshold(float x, float y)
+void ofxWebcamTracker::dispatchEvents()
 {
-  if(numWebcamsDetected() > 0){
-    drawEdgeThreshold(x, y, 1.0);
+  if(eventDelivery & OFX_WEBCAM_EVENTS_QUEUE)
+  {
+    for(size_t i=0; i<zoneEvents.size(); i++)
+    {
+      zoneEventQueue.push(zoneEvents[i]);
+    }
+  }
+
+  if(eventDelivery & OFX_WEBCAM_EVENTS_SYNC)
+  {
+    for(size_t i=0; i<zoneEvents.size(); i++)
+    {
+      ofxWebcamZoneEvent & event = zoneEvents[i];
+      switch(event.type)
+      {
+        case OFX_WEBCAM_ZONE_ENTERED: ofNotifyEvent(zoneEntered, event, this); break;
+        case OFX_WEBCAM_ZONE_EXITED: ofNotifyEvent(zoneExited, event, this); break;
+        case OFX_WEBCAM_TRIPWIRE_CROSSED: ofNotifyEvent(tripwireCrossed, event, this); break;
+      }
+    }
   }
+  zoneEvents.clear();
+
+  if(frameEvents.empty())
+  {
+    return;
+  }
+
+  if(eventDelivery & OFX_WEBCAM_EVENTS_QUEUE)
+  {
+    for(size_t i=0; i<frameEvents.size(); i++)
+    {
+      eventQueue.push(frameEvents[i]);
+    }
+  }
+
+  if(eventDelivery & OFX_WEBCAM_EVENTS_SYNC)
+  {
+    for(size_t i=0; i<frameEvents.size(); i++)
+    {
+      ofxWebcamBlobEvent & event = frameEvents[i];
+      switch(event.type)
+      {
+        case OFX_WEBCAM_BLOB_ENTERED: ofNotifyEvent(blobEntered, event, this); break;
+        case OFX_WEBCAM_BLOB_MOVED: ofNotifyEvent(blobMoved, event, this); break;
+        case OFX_WEBCAM_BLOB_LOST: ofNotifyEvent(blobLost, event, this); break;
+        case OFX_WEBCAM_BLOB_REMOVED: ofNotifyEvent(blobRemoved, event, this); break;
+        case OFX_WEBCAM_BLOB_OVERLAP_BEGAN: ofNotifyEvent(overlapBegan, event, this); break;
+        case OFX_WEBCAM_BLOB_OVERLAP_ENDED: ofNotifyEvent(overlapEnded, event, this); break;
+      }
+    }
+    ofNotifyEvent(blobEvents, frameEvents, this);
+  }
+
+  frameEvents.clear();
 }
 
-void ofxWebcamTracker::drawEdgeThreshold(float x, float y, float scale)
+bool ofxWebcamTracker::thereAreOverlaps()
 {
-  if(numWebcamsDetected() > 0){
-    ofNoFill();
-    ofSetColor(255, 90, 90);
-    ofDrawRectangle(x+(edgeThreshold * scale),y+(edgeThreshold * scale), (width*scale)-((edgeThreshold * scale)*2), (height*scale)-((edgeThreshold * scale)*2));
+  for(uint8_t b=0; b<blobs.size(); b++)
+  {
+    if(blobs[b].isOverlapping())
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+ofxWebcamBlob * ofxWebcamTracker::getOverlapBlob()
+{
+  for(uint8_t b=0; b<blobs.size(); b++)
+  {
+    if(!blobs[b].getMembers().empty() && blobs[b].isActive())
+    {
+      return &blobs[b];
+    }
+  }
+  return NULL;
+}
+
+//Every active blob that currently contains others.
+vector<ofxWebcamBlob *> ofxWebcamTracker::getOverlapBlobs()
+{
+  vector<ofxWebcamBlob *> hosts;
+  for(size_t b=0; b<blobs.size(); b++)
+  {
+    if(!blobs[b].getMembers().empty() && blobs[b].isActive())
+    {
+      hosts.push_back(&blobs[b]);
+    }
+  }
+  return hosts;
+}
+
+//Ids of the blobs merged into the blob with the given id.
+vector<int> ofxWebcamTracker::getMergedIds(int id)
+{
+  for(size_t b=0; b<blobs.size(); b++)
+  {
+    if(blobs[b].id == id)
+    {
+      return blobs[b].getMembers();
+    }
+  }
+  return vector<int>();
+}
+
+float ofxWebcamTracker::getMatchTime()
+{
+  return matchTime;
+}
+
+void ofxWebcamTracker::clearBlobs(){
+  for(size_t i=0; i<blobs.size(); i++)
+  {
+    emitBlobEvent(OFX_WEBCAM_BLOB_REMOVED, blobs[i]);
+  }
+  blobs.clear();
+  idLookup.clear();
+  gallery.clear(releasedTrajectories);
+  releasedTrajectories.clear();
+  trajectories.clear();
+}
+
+void ofxWebcamTracker::recordTrajectory(ofxWebcamBlob & blob)
+{
+  trajectories.push(blob.getTrajectory(), frameTime, blob.blob.centroid, blob.blob.area);
+}
+
+//Feeds the heatmap from the most precise source this frame has: the packed
+//mask, the 8 bit diff, or blob footprints when there is no background.
+void ofxWebcamTracker::updateHeatmap()
+{
+  float now = frameTime;
+  float dt = lastHeatmapUpdate > 0 ? now - lastHeatmapUpdate : 0;
+  lastHeatmapUpdate = now;
+
+  if(!heatmapEnabled)
+  {
+    return;
+  }
+
+  if(backgroundSubtract && usesPackedMask())
+  {
+    heatmap.addMask(mask, dt);
+  }
+  else if(backgroundSubtract)
+  {
+    heatmap.addPixels(diff.getPixels(), dt);
+  }
+  else
+  {
+    heatmap.addBlobs(blobs, dt);
+  }
+}
+
+//Events
+void ofxWebcamTracker::setEventDelivery(int modes)
+{
+  eventDelivery = modes;
+  if(eventDelivery == OFX_WEBCAM_EVENTS_NONE)
+  {
+    frameEvents.clear();
+  }
+}
+
+//Resets the queue, call it before a consumer thread starts popping.
+void ofxWebcamTracker::setEventQueueSize(int size)
+{
+  eventQueue.setup(size);
+  zoneEventQueue.setup(size);
+}
+
+int ofxWebcamTracker::getEventDelivery()
+{
+  return eventDelivery;
+}
+
+//Safe to call from one consumer thread while the tracker updates.
+bool ofxWebcamTracker::popEvent(ofxWebcamBlobEvent & event)
+{
+  return eventQueue.pop(event);
+}
+
+size_t ofxWebcamTracker::getDroppedEvents()
+{
+  return eventQueue.getDropped();
+}
+
+//Heatmap
+void ofxWebcamTracker::setHeatmap(bool value)
+{
+  heatmapEnabled = value;
+}
+
+void ofxWebcamTracker::setHeatmapCellSize(int value)
+{
+  heatmap.setup(width, height, value);
+}
+
+void ofxWebcamTracker::setHeatmapDecay(float perSecond)
+{
+  heatmap.setDecay(perSecond);
+}
+
+bool ofxWebcamTracker::getHeatmapEnabled()
+{
+  return heatmapEnabled;
+}
+
+ofxWebcamHeatmap & ofxWebcamTracker::getHeatmap()
+{
+  return heatmap;
+}
+
+//Trajectories
+//Starts every trajectory again. Tracks waiting in the reidentification
+//gallery get a new, empty slot too, since their old ones are gone.
+void ofxWebcamTracker::setTrajectoryLength(int samples)
+{
+  vector<ofxWebcamGallery::Entry> & waiting = gallery.getEntries();
+  releasedTrajectories.clear();
+  trajectories.setup(samples, MAX(32, (int)(blobs.size() + waiting.size())));
+  for(size_t i=0; i<blobs.size(); i++)
+  {
+    blobs[i].setTrajectory(trajectories.acquire());
+  }
+  for(size_t i=0; i<waiting.size(); i++)
+  {
+    waiting[i].trajectory = trajectories.acquire();
+  }
+}
+
+int ofxWebcamTracker::getTrajectoryLength()
+{
+  return trajectories.getCapacity();
+}
+
+ofxWebcamTrajectoryPool & ofxWebcamTracker::getTrajectories()
+{
+  return trajectories;
+}
+
+int ofxWebcamTracker::getPositions(ofxWebcamBlob & blob, float from, float to, vector<ofVec2f> & positions)
+{
+  return trajectories.getPositions(blob.getTrajectory(), from, to, positions);
+}
+
+ofVec2f ofxWebcamTracker::getAverageVelocity(ofxWebcamBlob & blob, float seconds)
+{
+  return trajectories.getAverageVelocity(blob.getTrajectory(), seconds);
+}
+
+float ofxWebcamTracker::getDistanceTravelled(ofxWebcamBlob & blob)
+{
+  return trajectories.getDistanceTravelled(blob.getTrajectory());
+}
+
+float ofxWebcamTracker::getDwellTime(ofxWebcamBlob & blob, const ofRectangle & rect)
+{
+  return trajectories.getDwellTime(blob.getTrajectory(), rect);
+}
+
+
+//Image Getters
+ofxCvColorImage ofxWebcamTracker::getColorImage(){
+  expandColor();
+  return colorImg;
+}
+
+ofxCvGrayscaleImage ofxWebcamTracker::getGrayImage(){
+  return grayscale;
+}
+
+//The thresholded foreground of the last frame, 255 where something is.
+ofPixels & ofxWebcamTracker::getDiffPixels(){
+  expandDiff();
+  return diff.getPixels();
+}
+
+//Previews
+//Downscaled debug images that are only produced while somebody asks for them,
+//at most getPreviewRate() times per second.
+void ofxWebcamTracker::setPreviewScale(float value){
+  for(int i=0; i<OFX_WEBCAM_PREVIEW_COUNT; i++)
+  {
+    previews[i].setScale(value);
+    previews[i].reset();
+  }
+}
+
+void ofxWebcamTracker::setPreviewRate(float fps){
+  for(int i=0; i<OFX_WEBCAM_PREVIEW_COUNT; i++)
+  {
+    previews[i].setRate(fps);
+  }
+}
+
+float ofxWebcamTracker::getPreviewScale(){
+  return previews[0].getScale();
+}
+
+float ofxWebcamTracker::getPreviewRate(){
+  return previews[0].getRate();
+}
+
+ofPixels & ofxWebcamTracker::getPreview(ofxWebcamPreviewView view){
+  ofxWebcamPreview & preview = previews[view];
+  float now = ofGetElapsedTimef();
+  if(initialized && preview.isDue(now))
+  {
+    switch(view)
+    {
+      case OFX_WEBCAM_PREVIEW_RGB:
+        expandColor();
+        preview.update(colorImg.getPixels(), now);
+        break;
+      case OFX_WEBCAM_PREVIEW_GRAYSCALE:
+        preview.update(grayscale.getPixels(), now);
+        break;
+      case OFX_WEBCAM_PREVIEW_BACKGROUND:
+        preview.update(background.getPixels(), now);
+        break;
+      case OFX_WEBCAM_PREVIEW_DIFF:
+        expandDiff();
+        preview.update(diff.getPixels(), now);
+        break;
+      default:
+        break;
+    }
+  }
+  return preview.getPixels();
+}
+
+//Snapshots
+//The blobs as of the last processed frame. Readers on other threads never
+//block the tracker, and the snapshot does not change while it is held.
+ofxWebcamSnapshotRef ofxWebcamTracker::getSnapshot(){
+  return snapshots.acquire();
+}
+
+//Blobs as they are at time (ofGetElapsedTimef() seconds, on the capture
+//clock), for drawing faster than the cameras deliver. Between the last two
+//updates positions are interpolated, after the last one they are predicted
+//from the velocity for at most the prediction horizon.
+int ofxWebcamTracker::getBlobsAt(float time, vector<ofxWebcamSnapshotBlob> & out){
+  return snapshots.getBlobsAt(time, predictionHorizon, out);
+}
+
+void ofxWebcamTracker::setPredictionHorizon(float millis){
+  predictionHorizon = MAX(0, millis) / 1000.0f;
+}
+
+float ofxWebcamTracker::getPredictionHorizon(){
+  return predictionHorizon * 1000.0f;
+}
+
+//Frames whose snapshot was dropped because readers held every slot.
+uint64_t ofxWebcamTracker::getSkippedSnapshots(){
+  return snapshots.getSkipped();
+}
+
+//Threading
+//Processing moves to a worker that waits for each new frame of the array.
+//update() still has to be called from the main thread to grab frames.
+//While running, read blobs and images between lock() and unlock().
+void ofxWebcamTracker::startThread(){
+  if(threadRunning) return;
+  threadRunning = true;
+  worker = std::thread(&ofxWebcamTracker::threadedFunction, this);
+}
+
+void ofxWebcamTracker::stopThread(){
+  if(!threadRunning) return;
+  threadRunning = false;
+  webcam->notifyWaiting();
+  if(worker.joinable())
+  {
+    worker.join();
+  }
+}
+
+bool ofxWebcamTracker::isThreadRunning(){
+  return threadRunning;
+}
+
+void ofxWebcamTracker::lock(){
+  processMutex.lock();
+}
+
+void ofxWebcamTracker::unlock(){
+  processMutex.unlock();
+}
+
+void ofxWebcamTracker::threadedFunction(){
+  while(threadRunning)
+  {
+    ofxWebcamFrame frame;
+    if(webcam->waitForFrame(lastFrameNumber, 100, frame))
+    {
+      process(frame);
+    }
   }
 }
 
 //Calibration
+void ofxWebcamTracker::setCpuStitch(bool value){
+  webcam->setCpuStitch(value);
+}
+
+//Call before init(); cameras that are already open keep their format.
+void ofxWebcamTracker::setLumaIngest(bool value){
+  webcam->setLumaIngest(value);
+}
+
+bool ofxWebcamTracker::getLumaIngest(){
+  return webcam->getLumaIngest();
+}
+
 void ofxWebcamTracker::calibratePosition(int index, ofPoint p){
-  webcam.calibratePosition(index, p);
+  webcam->calibratePosition(index, p);
+  adaptiveDirty = true;
+}
+
+//Writes the active blobs of every processed frame to a binary log at path.
+//Read it back with ofxWebcamLogReader.
+bool ofxWebcamTracker::startLog(string path, int keyframeInterval){
+  std::lock_guard<std::mutex> guard(processMutex);
+  return logWriter.open(path, keyframeInterval);
+}
+
+void ofxWebcamTracker::stopLog(){
+  std::lock_guard<std::mutex> guard(processMutex);
+  logWriter.close();
+}
+
+bool ofxWebcamTracker::isLogging(){
+  return logWriter.isOpen();
+}
+
+ofxWebcamLogWriter & ofxWebcamTracker::getLog(){
+  return logWriter;
 }
 
+//Zones and tripwires, in tracker pixels. Returns an id for the counts and
+//events, or -1 for a zone with less than 3 points.
+int ofxWebcamTracker::addZone(const vector<ofVec2f> & points, string name){
+  std::lock_guard<std::mutex> guard(processMutex);
+  return zones.addZone(points, name);
+}
+
+int ofxWebcamTracker::addZone(const ofRectangle & rect, string name){
+  std::lock_guard<std::mutex> guard(processMutex);
+  return zones.addZone(rect, name);
+}
+
+int ofxWebcamTracker::addTripwire(const ofVec2f & a, const ofVec2f & b, string name){
+  std::lock_guard<std::mutex> guard(processMutex);
+  return zones.addTripwire(a, b, name);
+}
+
+void ofxWebcamTracker::removeZone(int id){
+  std::lock_guard<std::mutex> guard(processMutex);
+  zones.removeZone(id);
+}
+
+void ofxWebcamTracker::removeTripwire(int id){
+  std::lock_guard<std::mutex> guard(processMutex);
+  zones.removeTripwire(id);
+}
+
+void ofxWebcamTracker::clearZones(){
+  std::lock_guard<std::mutex> guard(processMutex);
+  zones.clear();
+}
+
+//Counts are read without a lock, lock() around them when the tracker
+//runs on its own thread.
+ofxWebcamZones & ofxWebcamTracker::getZones(){
+  return zones;
+}
+
+float ofxWebcamTracker::getZoneTime(){
+  return zones.getTime();
+}
+
+//Zone events have a queue of their own, popped the same way as popEvent().
+bool ofxWebcamTracker::popZoneEvent(ofxWebcamZoneEvent & event){
+  return zoneEventQueue.pop(event);
+}
+
+size_t ofxWebcamTracker::getDroppedZoneEvents(){
+  return zoneEventQueue.getDropped();
+}
+
+//Closes the cameras unless another tracker still shares them.
 void ofxWebcamTracker::close(){
-  webcam.close();
+  stopThread();
+  stopLog();
+  if(webcam.use_count() == 1)
+  {
+    webcam->close();
+  }
 }
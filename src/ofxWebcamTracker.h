@@ -3,21 +3,109 @@
 #include "ofxOpenCv.h"
 #include "ofxWebcamBlob.h"
 #include "ofxWebcamArray.h"
+#include "ofxWebcamGovernor.h"
+#include "ofxWebcamBinaryMask.h"
+#include "ofxWebcamRunLabeller.h"
+#include "ofxWebcamTrajectory.h"
+#include "ofxWebcamHeatmap.h"
+#include "ofxWebcamEvents.h"
+#include "ofxWebcamBlobIndex.h"
+#include "ofxWebcamPreview.h"
+#include "ofxWebcamAdaptiveThreshold.h"
+#include "ofxWebcamShadowFilter.h"
+#include "ofxWebcamLatency.h"
+#include "ofxWebcamLog.h"
+#include "ofxWebcamFlow.h"
+#include "ofxWebcamSnapshot.h"
+#include "ofxWebcamZones.h"
+
+//A possible pairing of a detection with a tracked blob.
+struct ofxWebcamMatch {
+  float cost;
+  int detection;
+  int blob;
+};
+
+//Optional blob attributes, combined into the mask given to setBlobAttributes().
+enum ofxWebcamBlobAttribute {
+  OFX_WEBCAM_BLOB_BOUNDS = 0,
+  OFX_WEBCAM_BLOB_HULL = 1,
+  OFX_WEBCAM_BLOB_CONTOUR = 2
+};
+
+//Stages of the segmentation, combined into a key that picks one of the
+//instances compiled for every combination.
+enum ofxWebcamPipelineStage {
+  OFX_WEBCAM_PIPELINE_BLUR = 1,
+  OFX_WEBCAM_PIPELINE_SUBTRACT = 2,
+  OFX_WEBCAM_PIPELINE_PACKED = 4,
+  OFX_WEBCAM_PIPELINE_ADAPTIVE = 8,
+  OFX_WEBCAM_PIPELINE_SHADOWS = 16,
+  OFX_WEBCAM_PIPELINE_CLEAN = 32,
+  OFX_WEBCAM_PIPELINE_VARIANTS = 64
+};
+
+//Besides a key, setPipelineVariant() takes one of these.
+enum ofxWebcamPipelineVariant {
+  OFX_WEBCAM_PIPELINE_AUTO = -1,    //The instance for the current settings
+  OFX_WEBCAM_PIPELINE_GENERIC = -2  //Every setting checked as it runs
+};
 
 class ofxWebcamTracker {
   private:
-    ofxWebcamArray webcam;
+    shared_ptr<ofxWebcamArray> webcam;
     ofxCvColorImage colorImg;
+    shared_ptr<ofPixels> colorFrame;
+    ofPixels lumaPixels;
     ofxCvGrayscaleImage grayscale;
     ofxCvGrayscaleImage background;
     ofxCvGrayscaleImage diff;
+    ofxCvGrayscaleImage scaled;
     ofxCvContourFinder contourFinder;
+    ofxWebcamGovernor governor;
+    ofxWebcamBinaryMask mask;
+    ofxWebcamRunLabeller labeller;
+    vector<ofxCvBlob> detected;
+    vector<vector<ofPoint> > detectedHulls;
+    vector<ofPoint> hullPoints;
+    ofxWebcamTrajectoryPool trajectories;
+    ofxWebcamHeatmap heatmap;
+    ofxWebcamZones zones;
+    ofxWebcamEventQueue<ofxWebcamBlobEvent> eventQueue;
+    vector<ofxWebcamBlobEvent> frameEvents;
+    vector<ofxWebcamZoneEvent> zoneEvents;
+    ofxWebcamEventQueue<ofxWebcamZoneEvent> zoneEventQueue;
+    int eventDelivery;
+    ofxWebcamPreview previews[OFX_WEBCAM_PREVIEW_COUNT];
+
+    //Matching state, kept between frames to reuse the storage.
+    ofxWebcamBlobIndex blobIndex;
+    ofxWebcamBlobIndex detectionIndex;
+    ofxWebcamBlobIndex hostIndex;
+    vector<int> hosts;
+    vector<int> nearbyHosts;
+    float hostReach;
+    vector<ofPoint> indexPoints;
+    vector<int> neighbours;
+    vector<ofxWebcamMatch> matches;
+    vector<int> detectionOwner;
+    vector<bool> trackedBlob;
+    vector<bool> expiredBlob;
+    vector<pair<int, int> > idLookup;
 
     //flags
     bool backgroundSubtract;
     bool outdoorMode;
     bool blur;
     bool initialized;
+    bool packedMask;
+    int blobAttributes;
+    bool adaptiveThreshold;
+    bool adaptiveDirty;
+    bool shadowSuppression;
+    bool diffStale;
+    bool heatmapEnabled;
+    bool colorStale;
 
     float outdoorModeMinSpeed;
     float outdoorModeBgRefreshRate;
@@ -25,17 +113,112 @@ class ofxWebcamTracker {
     float threshold;
     float width;
     float height;
-    float maxBlobs;
+    int maxBlobs;
     float tolerance;
     float removeAfterSeconds;
     int idCounter;
     float minBlobSize;
     float edgeThreshold;
     float lastBackgroundGrab;
+    float contourScale;
+    int frameNumber;
+    ofxWebcamAdaptiveThreshold adaptive;
+    ofxWebcamShadowFilter shadowFilter;
+    ofxWebcamFlow flow;
+    ofxWebcamGallery gallery;
+    ofxWebcamAppearance detectionAppearance;
+    vector<int> releasedTrajectories;
+    bool reidentification;
+    float reidentificationTime;
+    float reidentificationDistance;
+    bool opticalFlow;
+    float flowTime;
+    float shadowTime;
+    size_t shadowPixels;
+    int adaptiveTilesX;
+    int adaptiveTilesY;
+    ofxWebcamMorphology morphology;
+    int morphologyRadius;
+    float morphologyTime;
+    float contourTime;
+    float lastHeatmapUpdate;
+    float matchTime;
+
+    //Threading
+    std::thread worker;
+    std::atomic<bool> threadRunning;
+    std::mutex processMutex;
+    uint64_t lastFrameNumber;
+    uint64_t lastCaptureTime;
+    bool captureAdvanced;
+    float frameTime;
+    ofxWebcamLatencyHistogram latency;
+    ofxWebcamLogWriter logWriter;
+    ofxWebcamSnapshotBuffer snapshots;
+    std::atomic<float> predictionHorizon;
+
+    //Segmentation pipeline, see ofxWebcamTrackerPipeline.cpp
+    typedef void (ofxWebcamTracker::*Segmenter)();
+    Segmenter segmenter;
+    int segmenterKey;
+    int pipelineVariant;
+    float segmentTime;
+    template<size_t... I> static Segmenter segmenterAt(int key, std::index_sequence<I...>);
+    template<bool Blur, bool Subtract, bool Packed, bool Adaptive, bool Shadows, bool Clean> void segment();
+    template<bool Packed, bool Adaptive> void thresholdDifference();
+    template<bool Packed> void suppressShadows();
+    template<bool Packed> void cleanMask();
+    void segmentGeneric();
+    void prepareAdaptive();
+    int pipelineKey();
+    void selectPipeline();
+
+    void setup();
+    void process(ofxWebcamFrame & frame);
+    void threadedFunction();
+
+    void findBlobs(ofxCvGrayscaleImage & image);
+    void extrapolateBlobs();
+    void estimateFlow();
+    bool computeAppearance(int detection, ofxWebcamAppearance & out);
+    void updateAppearance(ofxWebcamBlob & blob, int detection);
+    bool reidentify(int detection);
+    void releaseTrajectories();
+    void rememberFlow();
+    void labelBlobs();
+    void expandDiff();
+    void expandColor();
+    bool usesPackedMask();
+    void copyAttributes(ofxWebcamBlob & blob, int detection);
+    void recordTrajectory(ofxWebcamBlob & blob);
+    void updateHeatmap();
+    void updateZones();
+    void emitBlobEvent(ofxWebcamBlobEventType type, ofxWebcamBlob & blob, int otherId=-1);
+    void followHosts();
+    void findMerges();
+    void indexHosts();
+    bool findSplit(int detection);
+    void removeExpiredBlobs();
+    void buildIdLookup();
+    int findBlobIndex(int id);
+    void dispatchEvents();
 
   public:
     vector<ofxWebcamBlob> blobs;
 
+    //Blob lifecycle events, fired at the end of update() when
+    //OFX_WEBCAM_EVENTS_SYNC delivery is on.
+    ofEvent<ofxWebcamBlobEvent> blobEntered;
+    ofEvent<ofxWebcamBlobEvent> blobMoved;
+    ofEvent<ofxWebcamBlobEvent> blobLost;
+    ofEvent<ofxWebcamBlobEvent> blobRemoved;
+    ofEvent<ofxWebcamBlobEvent> overlapBegan;
+    ofEvent<ofxWebcamBlobEvent> overlapEnded;
+    ofEvent<vector<ofxWebcamBlobEvent> > blobEvents; //The whole frame in one batch
+    ofEvent<ofxWebcamZoneEvent> zoneEntered;
+    ofEvent<ofxWebcamZoneEvent> zoneExited;
+    ofEvent<ofxWebcamZoneEvent> tripwireCrossed;
+
     ofxWebcamTracker();
     ~ofxWebcamTracker();
 
@@ -54,6 +237,11 @@ class ofxWebcamTracker {
     void setOutdoorMode(bool value);
     void setOutdoorModeMinSpeed(float value);
     void setOutdoorModeBgRefreshRate(float value);
+    void setMaxBlobs(int value);
+    void setLatencyTarget(float millis);
+    void setMorphology(ofxWebcamMorphology mode);
+    void setMorphologyRadius(int value);
+    void setPackedMask(bool value);
     bool getBackgroundSubtract();
     bool getBlur();
     float getBlurAmount();
@@ -70,14 +258,63 @@ class ofxWebcamTracker {
     vector<ofxWebcamBlob> getActiveBlobs();
     float getOutdoorModeMinSpeed();
     float getOutdoorModeBgRefreshRate();
+    int getMaxBlobs();
+    float getLatencyTarget();
+    float getFrameTime();
+    float getCaptureTime();
+    void setCaptureOffset(float millis);
+    ofxWebcamLatencyHistogram & getLatency();
+    int getQualityLevel();
+    string getQualityLevelName();
+    ofxWebcamMorphology getMorphology();
+    int getMorphologyRadius();
+    float getMorphologyTime();
+    float getContourTime();
+    float getSegmentTime();
+    void setPipelineVariant(int variant);
+    int getPipelineVariant();
+    int getPipelineKey();
+    bool getPackedMask();
+    void setBlobAttributes(int flags);
+    int getBlobAttributes();
+    void setAdaptiveThreshold(bool value);
+    void setAdaptiveTiles(int columns, int rows);
+    void setAdaptiveGain(float value);
+    bool getAdaptiveThreshold();
+    float getAdaptiveGain();
+    vector<ofRectangle> & getAdaptiveRegions();
+    vector<float> & getAdaptiveThresholds();
+    void setShadowSuppression(bool value);
+    void setShadowBrightnessRange(float low, float high);
+    void setShadowChromaTolerance(float value);
+    bool getShadowSuppression();
+    float getShadowTime();
+    size_t getShadowPixels();
+    void setOpticalFlow(bool value);
+    bool getOpticalFlow();
+    float getFlowTime();
+    void setReidentification(bool value);
+    void setReidentificationTime(float seconds);
+    void setReidentificationDistance(float value);
+    void setGallerySize(int tracks);
+    bool getReidentification();
+    float getReidentificationTime();
+    float getReidentificationDistance();
+    ofxWebcamGallery & getGallery();
+    size_t getForegroundArea();
     bool isOverlapCandidate(ofxWebcamBlob blob);
     bool thereAreOverlaps();
     bool shouldGrabBackground();
     ofxWebcamBlob * getOverlapBlob();
+    vector<ofxWebcamBlob *> getOverlapBlobs();
+    vector<int> getMergedIds(int id);
+    float getMatchTime();
 
     //Action Methods
     void init(vector<ofVideoDevice> active, int resolutionWidth=DEFAULT_RES_WIDTH, int resolutionHeight=DEFAULT_RES_HEIGHT);
     void init(int resolutionWidth=DEFAULT_RES_WIDTH, int resolutionHeight=DEFAULT_RES_HEIGHT);
+    void init(shared_ptr<ofxWebcamArray> shared);
+    shared_ptr<ofxWebcamArray> getWebcamArray();
     void update();
     void grabBackground();
     void subtractBackground();
@@ -89,8 +326,17 @@ class ofxWebcamTracker {
     //Image Getters
     ofxCvColorImage getColorImage();
     ofxCvGrayscaleImage getGrayImage();
+    ofPixels & getDiffPixels();
 
+    //Previews
+    void setPreviewScale(float value);
+    void setPreviewRate(float fps);
+    float getPreviewScale();
+    float getPreviewRate();
+    ofPixels & getPreview(ofxWebcamPreviewView view);
 
+
+#ifndef OFX_WEBCAM_TRACKER_HEADLESS
     //Draw and debug methods
     void draw();
     void drawRGB(float x, float y);
@@ -109,8 +355,68 @@ class ofxWebcamTracker {
     void drawDebug(float x, float y, float scale);
     void drawEdgeThreshold(float x, float y);
     void drawEdgeThreshold(float x, float y, float scale);
+    void drawPreview(ofxWebcamPreviewView view, float x, float y, float scale);
+#endif
+
+    //Trajectories
+    void setTrajectoryLength(int samples);
+    int getTrajectoryLength();
+    ofxWebcamTrajectoryPool & getTrajectories();
+    int getPositions(ofxWebcamBlob & blob, float from, float to, vector<ofVec2f> & positions);
+    ofVec2f getAverageVelocity(ofxWebcamBlob & blob, float seconds);
+    float getDistanceTravelled(ofxWebcamBlob & blob);
+    float getDwellTime(ofxWebcamBlob & blob, const ofRectangle & rect);
+
+    //Events
+    void setEventDelivery(int modes);
+    void setEventQueueSize(int size);
+    int getEventDelivery();
+    bool popEvent(ofxWebcamBlobEvent & event);
+    size_t getDroppedEvents();
+
+    //Heatmap
+    void setHeatmap(bool value);
+    void setHeatmapCellSize(int value);
+    void setHeatmapDecay(float perSecond);
+    bool getHeatmapEnabled();
+    ofxWebcamHeatmap & getHeatmap();
+
+    //Logging
+    bool startLog(string path, int keyframeInterval=DEFAULT_LOG_KEYFRAME_INTERVAL);
+    void stopLog();
+    bool isLogging();
+    ofxWebcamLogWriter & getLog();
+
+    //Zones and tripwires
+    int addZone(const vector<ofVec2f> & points, string name="");
+    int addZone(const ofRectangle & rect, string name="");
+    int addTripwire(const ofVec2f & a, const ofVec2f & b, string name="");
+    void removeZone(int id);
+    void removeTripwire(int id);
+    void clearZones();
+    ofxWebcamZones & getZones();
+    float getZoneTime();
+    bool popZoneEvent(ofxWebcamZoneEvent & event);
+    size_t getDroppedZoneEvents();
+
+    //Snapshots, safe to read from any thread
+    ofxWebcamSnapshotRef getSnapshot();
+    uint64_t getSkippedSnapshots();
+    int getBlobsAt(float time, vector<ofxWebcamSnapshotBlob> & out);
+    void setPredictionHorizon(float millis);
+    float getPredictionHorizon();
+
+    //Threading
+    void startThread();
+    void stopThread();
+    bool isThreadRunning();
+    void lock();
+    void unlock();
 
     //Calibration
+    void setCpuStitch(bool value);
+    void setLumaIngest(bool value);
+    bool getLumaIngest();
     void calibratePosition(int index, ofPoint p);
 
     //closing
@@ -0,0 +1,218 @@
+#include "ofxWebcamTracker.h"
+
+//Everything that needs a renderer lives here, so headless builds can leave
+//it out by defining OFX_WEBCAM_TRACKER_HEADLESS.
+#ifndef OFX_WEBCAM_TRACKER_HEADLESS
+
+//Draw and debug methods
+void ofxWebcamTracker::drawRGB(float x, float y)
+{
+  if(webcam->isInitialized()){
+    expandColor();
+    ofSetColor(255);
+    colorImg.draw(x, y, width, height);
+  }
+}
+
+void ofxWebcamTracker::drawRGB(float x, float y, float scale)
+{
+  if(webcam->isInitialized()){
+    expandColor();
+    ofSetColor(255);
+    colorImg.draw(x, y, width*scale, height*scale);
+  }
+}
+
+void ofxWebcamTracker::drawGrayscale(float x, float y)
+{
+  if(webcam->isInitialized()){
+    ofSetColor(255);
+    grayscale.draw(x, y, width, height);
+  }
+}
+
+void ofxWebcamTracker::drawGrayscale(float x, float y, float scale)
+{
+  if(webcam->isInitialized()){
+    ofSetColor(255);
+    grayscale.draw(x, y, width*scale, height*scale);
+  }
+}
+
+void ofxWebcamTracker::drawBlobPositions(float x, float y)
+{
+  if(webcam->isInitialized()){
+    drawBlobPositions(x,y,1.0);
+  }
+}
+
+void ofxWebcamTracker::drawBlobPositions(float x, float y, float scale)
+{
+  if(webcam->isInitialized()){
+    for (uint8_t i = 0; i < blobs.size(); i++)
+    {
+      if(blobs[i].isActive())
+      {
+        ofFill();
+        ofSetColor(255,0,0);
+        ofDrawCircle(x+ blobs[i].blob.centroid.x * scale,
+          y+ blobs[i].blob.centroid.y * scale,
+          10);
+
+        ofSetColor(255);
+        ofDrawBitmapString(ofToString(blobs[i].id),
+        x+ blobs[i].blob.centroid.x * scale,
+        y+ blobs[i].blob.centroid.y * scale);
+
+        if(blobs[i].isOverlapping())
+        {
+          ofSetLineWidth(10);
+          ofNoFill();
+          ofSetColor(255,0,0);
+          ofDrawRectangle(x+blobs[i].blob.boundingRect.x * scale,
+            y+blobs[i].blob.boundingRect.y * scale,
+            blobs[i].blob.boundingRect.width * scale,
+            blobs[i].blob.boundingRect.height * scale);
+          ofSetLineWidth(1);
+        }
+      }
+      else {
+        ofNoFill();
+        ofDrawCircle(x+ blobs[i].blob.centroid.x * scale,
+          y+ blobs[i].blob.centroid.y * scale,
+          10);
+
+        ofSetColor(255);
+        ofDrawBitmapString(ofToString(blobs[i].id),
+        x+ blobs[i].blob.centroid.x * scale,
+        y+ blobs[i].blob.centroid.y * scale);
+      }
+    }
+  }
+}
+
+void ofxWebcamTracker::drawBackground(float x, float y)
+{
+  if(webcam->isInitialized() && backgroundSubtract){
+    ofSetColor(255);
+    background.draw(x,y);
+  }
+}
+
+void ofxWebcamTracker::drawBackground(float x, float y, float scale)
+{
+  if(webcam->isInitialized() && backgroundSubtract){
+    ofSetColor(255);
+    background.draw(x,y,width*scale, height*scale);
+  }
+}
+
+void ofxWebcamTracker::drawContours(float x, float y)
+{
+  if(webcam->isInitialized()){
+    drawContours(x,y,1.0);
+  }
+}
+
+void ofxWebcamTracker::drawContours(float x, float y, float scale)
+{
+  if(webcam->isInitialized() && usesPackedMask() && backgroundSubtract){
+    //Labelled blobs have no contour, show their bounds and hulls instead.
+    ofNoFill();
+    ofSetColor(255, 0, 255);
+    for(size_t i=0; i<detected.size(); i++)
+    {
+      ofRectangle & r = detected[i].boundingRect;
+      ofDrawRectangle(x + r.x*scale, y + r.y*scale, r.width*scale, r.height*scale);
+    }
+    if(blobAttributes & OFX_WEBCAM_BLOB_HULL)
+    {
+      for(size_t i=0; i<detectedHulls.size() && i<detected.size(); i++)
+      {
+        vector<ofPoint> & hull = detectedHulls[i];
+        for(size_t p=0; p<hull.size(); p++)
+        {
+          ofPoint & a = hull[p];
+          ofPoint & b = hull[(p + 1) % hull.size()];
+          ofDrawLine(x + a.x*scale, y + a.y*scale, x + b.x*scale, y + b.y*scale);
+        }
+      }
+    }
+  }
+  else if(webcam->isInitialized()){
+    //The contour finder scales against the image it ran on, which may be smaller than the tracker.
+    contourFinder.draw(x,y,width*scale*contourScale,height*scale*contourScale);
+  }
+}
+
+void ofxWebcamTracker::drawDiff(float x, float y)
+{
+  if(webcam->isInitialized() && backgroundSubtract){
+    expandDiff();
+    ofSetColor(255);
+    diff.draw(x, y);
+  }
+}
+
+void ofxWebcamTracker::drawDiff(float x, float y, float scale)
+{
+  if(webcam->isInitialized() && backgroundSubtract){
+    expandDiff();
+    ofSetColor(255);
+    diff.draw(x,y,width*scale,height*scale);
+  }
+}
+
+void ofxWebcamTracker::drawDebug(float x, float y)
+{
+  if(webcam->isInitialized()){
+    drawDebug(x, y, 1.0);
+  }
+}
+
+
+void ofxWebcamTracker::drawDebug(float x, float y, float scale)
+{
+  if(webcam->isInitialized())
+  {
+    drawPreview      (OFX_WEBCAM_PREVIEW_GRAYSCALE, x, y, 0.5 * scale);
+    if(backgroundSubtract)
+    {
+      drawPreview    (OFX_WEBCAM_PREVIEW_BACKGROUND, x+width*scale/2, y, 0.5 * scale);
+      drawPreview    (OFX_WEBCAM_PREVIEW_DIFF, x, y+height*scale/2, 0.5 * scale);
+    }
+    drawPreview      (OFX_WEBCAM_PREVIEW_RGB, x+width*scale/2, y+height*scale/2, 0.5 * scale);
+    drawContours     (x+width*scale/2, y+height*scale/2, 0.5 * scale);
+    drawBlobPositions(x+width*scale/2, y+height*scale/2, 0.5 * scale);
+    drawEdgeThreshold(x+width*scale/2, y+height*scale/2, 0.5 * scale);
+  }
+}
+
+//Draws a rate limited, downscaled preview. Nothing is produced for a view
+//that is never drawn.
+void ofxWebcamTracker::drawPreview(ofxWebcamPreviewView view, float x, float y, float scale)
+{
+  if(webcam->isInitialized()){
+    getPreview(view);
+    ofSetColor(255);
+    previews[view].draw(x, y, width*scale, height*scale);
+  }
+}
+
+void ofxWebcamTracker::drawEdgeThreshold(float x, float y)
+{
+  if(webcam->isInitialized()){
+    drawEdgeThreshold(x, y, 1.0);
+  }
+}
+
+void ofxWebcamTracker::drawEdgeThreshold(float x, float y, float scale)
+{
+  if(webcam->isInitialized()){
+    ofNoFill();
+    ofSetColor(255, 90, 90);
+    ofDrawRectangle(x+(edgeThreshold * scale),y+(edgeThreshold * scale), (width*scale)-((edgeThreshold * scale)*2), (height*scale)-((edgeThreshold * scale)*2));
+  }
+}
+
+#endif
@@ -0,0 +1,283 @@
+#include "ofxWebcamTracker.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+//The segmentation stages, composed at compile time. Every combination of
+//the ofxWebcamPipelineStage flags is its own instance of segment<>(), with
+//the disabled stages compiled out. process() looks the instance up again
+//only when a setting changes or the governor drops the blur.
+
+//d = 255 where |a - b| >= threshold, 0 elsewhere, without a branch per pixel.
+static void thresholdPixels(const unsigned char * a, const unsigned char * b, unsigned char * d, size_t n, float threshold)
+{
+  int limit = (int)ceil(ofClamp(threshold, 0, 255));
+  if(limit == 0)
+  {
+    memset(d, 255, n);
+    return;
+  }
+
+  size_t i = 0;
+#if defined(__SSE2__)
+  const __m128i below = _mm_set1_epi8((char)(limit - 1));
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i ones = _mm_set1_epi8((char)0xFF);
+  for(; i + 16 <= n; i += 16)
+  {
+    __m128i va = _mm_loadu_si128((const __m128i *)(a + i));
+    __m128i vb = _mm_loadu_si128((const __m128i *)(b + i));
+    __m128i diff = _mm_or_si128(_mm_subs_epu8(va, vb), _mm_subs_epu8(vb, va));
+    __m128i background = _mm_cmpeq_epi8(_mm_subs_epu8(diff, below), zero);
+    _mm_storeu_si128((__m128i *)(d + i), _mm_xor_si128(background, ones));
+  }
+#endif
+
+  for(; i < n; i++)
+  {
+    d[i] = (unsigned char)-(abs(a[i] - b[i]) >= limit);
+  }
+}
+
+void ofxWebcamTracker::prepareAdaptive()
+{
+  if(adaptiveDirty)
+  {
+    adaptive.setMinThreshold(threshold);
+    adaptive.setup(width, height, webcam->getCameraRects(), adaptiveTilesX, adaptiveTilesY);
+    adaptiveDirty = false;
+  }
+  adaptive.setMinThreshold(threshold);
+}
+
+template<bool Packed, bool Adaptive>
+void ofxWebcamTracker::thresholdDifference()
+{
+  if(Adaptive)
+  {
+    prepareAdaptive();
+  }
+
+  if(Packed)
+  {
+    //The 8 bit diff is only rebuilt from the mask when something draws it.
+    if(Adaptive)
+    {
+      adaptive.apply(grayscale.getPixels(), background.getPixels(), mask);
+    }
+    else
+    {
+      mask.setFromDifference(grayscale.getPixels(), background.getPixels(), threshold);
+    }
+    diffStale = true;
+  }
+  else
+  {
+    if(Adaptive)
+    {
+      adaptive.apply(grayscale.getPixels(), background.getPixels(), diff.getPixels());
+    }
+    else
+    {
+      ofPixels & pix = grayscale.getPixels();
+      thresholdPixels(pix.getData(), background.getPixels().getData(), diff.getPixels().getData(), pix.size(), threshold);
+    }
+    diff.flagImageChanged();
+  }
+}
+
+//Without a color frame (luma ingest) or a color background there is
+//nothing to compare shadows against.
+template<bool Packed>
+void ofxWebcamTracker::suppressShadows()
+{
+  if(!colorFrame || !shadowFilter.hasBackground())
+  {
+    shadowTime = 0;
+    shadowPixels = 0;
+    return;
+  }
+
+  uint64_t start = ofGetElapsedTimeMicros();
+  if(Packed)
+  {
+    shadowPixels = shadowFilter.apply(*colorFrame, mask);
+  }
+  else
+  {
+    shadowPixels = shadowFilter.apply(*colorFrame, diff.getPixels());
+    diff.flagImageChanged();
+  }
+  shadowTime = (ofGetElapsedTimeMicros() - start) / 1000.0f;
+}
+
+//Opens and/or closes the thresholded diff so noise specks and split people
+//do not reach the contour finder.
+template<bool Packed>
+void ofxWebcamTracker::cleanMask()
+{
+  uint64_t start = ofGetElapsedTimeMicros();
+  if(Packed)
+  {
+    mask.apply(morphology, morphologyRadius);
+  }
+  else
+  {
+    mask.setFromPixels(diff.getPixels());
+    mask.apply(morphology, morphologyRadius);
+    mask.toPixels(diff.getPixels());
+    diff.flagImageChanged();
+  }
+  morphologyTime = (ofGetElapsedTimeMicros() - start) / 1000.0f;
+}
+
+template<bool Blur, bool Subtract, bool Packed, bool Adaptive, bool Shadows, bool Clean>
+void ofxWebcamTracker::segment()
+{
+  if(Blur)
+  {
+    grayscale.blurGaussian(blurAmount);
+  }
+
+  if(!Subtract)
+  {
+    findBlobs(grayscale);
+    return;
+  }
+
+  thresholdDifference<Packed, Adaptive>();
+
+  if(Shadows)
+  {
+    suppressShadows<Packed>();
+  }
+  else
+  {
+    shadowTime = 0;
+    shadowPixels = 0;
+  }
+
+  if(Clean)
+  {
+    cleanMask<Packed>();
+  }
+  else
+  {
+    morphologyTime = 0;
+  }
+
+  if(Packed)
+  {
+    labelBlobs();
+  }
+  else
+  {
+    findBlobs(diff);
+  }
+}
+
+template<size_t... I>
+ofxWebcamTracker::Segmenter ofxWebcamTracker::segmenterAt(int key, std::index_sequence<I...>)
+{
+  static const ofxWebcamTracker::Segmenter table[] = {
+    &ofxWebcamTracker::segment<(I & OFX_WEBCAM_PIPELINE_BLUR) != 0, (I & OFX_WEBCAM_PIPELINE_SUBTRACT) != 0, (I & OFX_WEBCAM_PIPELINE_PACKED) != 0,
+                               (I & OFX_WEBCAM_PIPELINE_ADAPTIVE) != 0, (I & OFX_WEBCAM_PIPELINE_SHADOWS) != 0, (I & OFX_WEBCAM_PIPELINE_CLEAN) != 0>...
+  };
+  return table[key];
+}
+
+//The same stages as segment<>(), with every setting checked as they run.
+void ofxWebcamTracker::segmentGeneric()
+{
+  if(blur && governor.shouldBlur())
+  {
+    grayscale.blurGaussian(blurAmount);
+  }
+
+  if(!backgroundSubtract)
+  {
+    findBlobs(grayscale);
+    return;
+  }
+
+  bool packed = usesPackedMask();
+  subtractBackground();
+
+  if(shadowSuppression)
+  {
+    if(packed) suppressShadows<true>();
+    else suppressShadows<false>();
+  }
+  else
+  {
+    shadowTime = 0;
+    shadowPixels = 0;
+  }
+
+  if(morphology != OFX_WEBCAM_MORPHOLOGY_NONE)
+  {
+    if(packed) cleanMask<true>();
+    else cleanMask<false>();
+  }
+  else
+  {
+    morphologyTime = 0;
+  }
+
+  if(packed)
+  {
+    labelBlobs();
+  }
+  else
+  {
+    findBlobs(diff);
+  }
+}
+
+//Settings that only matter after background subtraction are left out of the
+//key without it, so those variants are never picked.
+int ofxWebcamTracker::pipelineKey()
+{
+  int key = blur ? OFX_WEBCAM_PIPELINE_BLUR : 0;
+  if(backgroundSubtract)
+  {
+    key |= OFX_WEBCAM_PIPELINE_SUBTRACT;
+    if(usesPackedMask()) key |= OFX_WEBCAM_PIPELINE_PACKED;
+    if(adaptiveThreshold) key |= OFX_WEBCAM_PIPELINE_ADAPTIVE;
+    if(shadowSuppression) key |= OFX_WEBCAM_PIPELINE_SHADOWS;
+    if(morphology != OFX_WEBCAM_MORPHOLOGY_NONE) key |= OFX_WEBCAM_PIPELINE_CLEAN;
+  }
+  return key;
+}
+
+//The governor's blur decision changes from frame to frame, so it is part of
+//the key rather than a check inside the instance.
+void ofxWebcamTracker::selectPipeline()
+{
+  if(pipelineVariant == OFX_WEBCAM_PIPELINE_GENERIC)
+  {
+    segmenter = &ofxWebcamTracker::segmentGeneric;
+    segmenterKey = OFX_WEBCAM_PIPELINE_GENERIC;
+    return;
+  }
+
+  int key = pipelineVariant == OFX_WEBCAM_PIPELINE_AUTO ? pipelineKey() : pipelineVariant;
+  if(!governor.shouldBlur())
+  {
+    key &= ~OFX_WEBCAM_PIPELINE_BLUR;
+  }
+  if(key != segmenterKey || segmenter == NULL)
+  {
+    segmenter = segmenterAt(key, std::make_index_sequence<OFX_WEBCAM_PIPELINE_VARIANTS>());
+    segmenterKey = key;
+  }
+}
+
+void ofxWebcamTracker::subtractBackground() {
+  bool packed = usesPackedMask();
+  if(packed && adaptiveThreshold) thresholdDifference<true, true>();
+  else if(packed) thresholdDifference<true, false>();
+  else if(adaptiveThreshold) thresholdDifference<false, true>();
+  else thresholdDifference<false, false>();
+}
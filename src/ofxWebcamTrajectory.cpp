@@ -0,0 +1,167 @@
+#include "ofxWebcamTrajectory.h"
+
+ofxWebcamTrajectoryPool::ofxWebcamTrajectoryPool() : capacity(0) {
+
+}
+
+ofxWebcamTrajectoryPool::~ofxWebcamTrajectoryPool(){
+
+}
+
+void ofxWebcamTrajectoryPool::setup(int samplesPerBlob, int initialSlots)
+{
+  capacity = MAX(2, samplesPerBlob);
+  samples.clear();
+  rings.clear();
+  freeSlots.clear();
+  grow(initialSlots);
+}
+
+void ofxWebcamTrajectoryPool::grow(int slots)
+{
+  int first = rings.size();
+  Ring unused = {0, 0, 0, false};
+  samples.resize((size_t)(first + slots) * capacity);
+  rings.resize(first + slots, unused);
+  for(int i=first + slots - 1; i>=first; i--)
+  {
+    freeSlots.push_back(i);
+  }
+}
+
+void ofxWebcamTrajectoryPool::clear()
+{
+  freeSlots.clear();
+  for(int i=rings.size() - 1; i>=0; i--)
+  {
+    rings[i].used = false;
+    freeSlots.push_back(i);
+  }
+}
+
+int ofxWebcamTrajectoryPool::getCapacity()
+{
+  return capacity;
+}
+
+int ofxWebcamTrajectoryPool::acquire()
+{
+  if(capacity == 0)
+  {
+    setup();
+  }
+
+  if(freeSlots.empty())
+  {
+    grow(MAX(1, (int)rings.size()));
+  }
+
+  int slot = freeSlots.back();
+  freeSlots.pop_back();
+  Ring ring = {0, 0, 0, true};
+  rings[slot] = ring;
+  return slot;
+}
+
+void ofxWebcamTrajectoryPool::release(int slot)
+{
+  if(slot >= 0 && slot < (int)rings.size() && rings[slot].used)
+  {
+    rings[slot].used = false;
+    freeSlots.push_back(slot);
+  }
+}
+
+void ofxWebcamTrajectoryPool::push(int slot, float time, ofVec2f centroid, float area)
+{
+  if(slot < 0 || slot >= (int)rings.size()) return;
+
+  Ring & ring = rings[slot];
+  ofxWebcamTrajectorySample * base = &samples[(size_t)slot * capacity];
+
+  if(ring.count > 0)
+  {
+    const ofxWebcamTrajectorySample & last = base[(ring.head + capacity - 1) % capacity];
+    ring.distance += last.centroid.distance(centroid);
+  }
+
+  ofxWebcamTrajectorySample & s = base[ring.head];
+  s.time = time;
+  s.centroid = centroid;
+  s.area = area;
+
+  ring.head = (ring.head + 1) % capacity;
+  if(ring.count < capacity) ring.count++;
+}
+
+int ofxWebcamTrajectoryPool::size(int slot)
+{
+  if(slot < 0 || slot >= (int)rings.size()) return 0;
+  return rings[slot].count;
+}
+
+const ofxWebcamTrajectorySample & ofxWebcamTrajectoryPool::get(int slot, int index)
+{
+  const Ring & ring = rings[slot];
+  int oldest = (ring.head + capacity - ring.count) % capacity;
+  return samples[(size_t)slot * capacity + (oldest + index) % capacity];
+}
+
+//Fills positions (reusing its storage) with the centroids seen between from and to.
+int ofxWebcamTrajectoryPool::getPositions(int slot, float from, float to, vector<ofVec2f> & positions)
+{
+  positions.clear();
+  int n = size(slot);
+  for(int i=0; i<n; i++)
+  {
+    const ofxWebcamTrajectorySample & s = get(slot, i);
+    if(s.time >= from && s.time <= to)
+    {
+      positions.push_back(s.centroid);
+    }
+  }
+  return positions.size();
+}
+
+//Units per second over the last given seconds of the trajectory.
+ofVec2f ofxWebcamTrajectoryPool::getAverageVelocity(int slot, float seconds)
+{
+  int n = size(slot);
+  if(n < 2) return ofVec2f(0, 0);
+
+  const ofxWebcamTrajectorySample & last = get(slot, n - 1);
+  int first = n - 1;
+  while(first > 0 && last.time - get(slot, first - 1).time <= seconds)
+  {
+    first--;
+  }
+
+  const ofxWebcamTrajectorySample & start = get(slot, first);
+  float dt = last.time - start.time;
+  if(dt <= 0) return ofVec2f(0, 0);
+  return (last.centroid - start.centroid) / dt;
+}
+
+//Total path length since the blob appeared, not only what is still in the ring.
+float ofxWebcamTrajectoryPool::getDistanceTravelled(int slot)
+{
+  if(slot < 0 || slot >= (int)rings.size()) return 0;
+  return rings[slot].distance;
+}
+
+//Seconds spent inside rect, within the span the ring still remembers.
+float ofxWebcamTrajectoryPool::getDwellTime(int slot, const ofRectangle & rect)
+{
+  float dwell = 0;
+  int n = size(slot);
+  for(int i=1; i<n; i++)
+  {
+    const ofxWebcamTrajectorySample & a = get(slot, i - 1);
+    const ofxWebcamTrajectorySample & b = get(slot, i);
+    if(rect.inside(a.centroid.x, a.centroid.y) && rect.inside(b.centroid.x, b.centroid.y))
+    {
+      dwell += b.time - a.time;
+    }
+  }
+  return dwell;
+}
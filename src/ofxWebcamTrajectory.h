@@ -0,0 +1,50 @@
+#pragma once
+#include "ofMain.h"
+
+#define DEFAULT_TRAJECTORY_LENGTH 128
+
+struct ofxWebcamTrajectorySample {
+  float time;
+  ofVec2f centroid;
+  float area;
+};
+
+//Fixed capacity trajectory rings for every tracked blob, stored back to back
+//in one arena. A blob holds a slot index; pushing and querying never allocate.
+//The arena only grows when more blobs are alive than there are slots.
+class ofxWebcamTrajectoryPool {
+  private:
+    struct Ring {
+      int head;
+      int count;
+      float distance;
+      bool used;
+    };
+
+    int capacity;
+    vector<ofxWebcamTrajectorySample> samples;
+    vector<Ring> rings;
+    vector<int> freeSlots;
+
+    void grow(int slots);
+
+  public:
+    ofxWebcamTrajectoryPool();
+    ~ofxWebcamTrajectoryPool();
+
+    void setup(int samplesPerBlob=DEFAULT_TRAJECTORY_LENGTH, int initialSlots=32);
+    void clear();
+    int getCapacity();
+
+    int acquire();
+    void release(int slot);
+    void push(int slot, float time, ofVec2f centroid, float area);
+
+    int size(int slot);
+    const ofxWebcamTrajectorySample & get(int slot, int index); //0 is the oldest sample
+
+    int getPositions(int slot, float from, float to, vector<ofVec2f> & positions);
+    ofVec2f getAverageVelocity(int slot, float seconds);
+    float getDistanceTravelled(int slot);
+    float getDwellTime(int slot, const ofRectangle & rect);
+};
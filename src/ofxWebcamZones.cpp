@@ -0,0 +1,470 @@
+#include "ofxWebcamZones.h"
+
+//Positive on the right of a->b as seen on screen (y down), negative on its left.
+static inline float sideOf(const ofVec2f & a, const ofVec2f & b, const ofVec2f & p)
+{
+  return (b.x - a.x) * (p.y - a.y) - (b.y - a.y) * (p.x - a.x);
+}
+
+ofxWebcamZones::ofxWebcamZones() : nextId(0), imageWidth(1), imageHeight(1), cellSize(DEFAULT_ZONE_CELL_SIZE), cols(1), rows(1), dirty(true), stamp(0), generation(0), evaluated(0), time(0) {
+
+}
+
+ofxWebcamZones::~ofxWebcamZones(){
+
+}
+
+void ofxWebcamZones::setup(int width, int height, int size)
+{
+  imageWidth = MAX(1, width);
+  imageHeight = MAX(1, height);
+  cellSize = MAX(1, size);
+  dirty = true;
+}
+
+int ofxWebcamZones::getCellSize()
+{
+  return cellSize;
+}
+
+int ofxWebcamZones::cellX(float x)
+{
+  return (int)ofClamp(floor(x / cellSize), 0, cols - 1);
+}
+
+int ofxWebcamZones::cellY(float y)
+{
+  return (int)ofClamp(floor(y / cellSize), 0, rows - 1);
+}
+
+int ofxWebcamZones::addZone(const vector<ofVec2f> & points, string name)
+{
+  if(points.size() < 3)
+  {
+    ofLogWarning("ofxWebcamZones") << "A zone needs at least 3 points";
+    return -1;
+  }
+
+  ofxWebcamZone zone;
+  zone.id = nextId++;
+  zone.name = name;
+  zone.points = points;
+  ofVec2f low = points[0];
+  ofVec2f high = points[0];
+  for(size_t i=1; i<points.size(); i++)
+  {
+    low.x = MIN(low.x, points[i].x);
+    low.y = MIN(low.y, points[i].y);
+    high.x = MAX(high.x, points[i].x);
+    high.y = MAX(high.y, points[i].y);
+  }
+  zone.bounds.set(low.x, low.y, high.x - low.x, high.y - low.y);
+  zone.occupancy = 0;
+  zone.entries = 0;
+  zone.exits = 0;
+  zones.push_back(zone);
+  dirty = true;
+  return zone.id;
+}
+
+int ofxWebcamZones::addZone(const ofRectangle & rect, string name)
+{
+  vector<ofVec2f> points;
+  points.push_back(ofVec2f(rect.getLeft(), rect.getTop()));
+  points.push_back(ofVec2f(rect.getRight(), rect.getTop()));
+  points.push_back(ofVec2f(rect.getRight(), rect.getBottom()));
+  points.push_back(ofVec2f(rect.getLeft(), rect.getBottom()));
+  return addZone(points, name);
+}
+
+int ofxWebcamZones::addTripwire(const ofVec2f & a, const ofVec2f & b, string name)
+{
+  ofxWebcamTripwire wire;
+  wire.id = nextId++;
+  wire.name = name;
+  wire.a = a;
+  wire.b = b;
+  wire.forward = 0;
+  wire.backward = 0;
+  tripwires.push_back(wire);
+  dirty = true;
+  return wire.id;
+}
+
+//Blobs inside a removed zone just stop counting for it, no exit is sent.
+void ofxWebcamZones::removeZone(int id)
+{
+  int index = findZoneIndex(id);
+  if(index == -1) return;
+
+  zones.erase(zones.begin() + index);
+  for(auto & it : tracks)
+  {
+    vector<int> & inside = it.second.inside;
+    for(size_t i=0; i<inside.size(); )
+    {
+      if(inside[i] == index)
+      {
+        inside.erase(inside.begin() + i);
+        continue;
+      }
+      if(inside[i] > index) inside[i]--;
+      i++;
+    }
+  }
+  dirty = true;
+}
+
+void ofxWebcamZones::removeTripwire(int id)
+{
+  int index = findTripwireIndex(id);
+  if(index == -1) return;
+
+  tripwires.erase(tripwires.begin() + index);
+  dirty = true;
+}
+
+void ofxWebcamZones::clear()
+{
+  zones.clear();
+  tripwires.clear();
+  tracks.clear();
+  dirty = true;
+}
+
+//Occupancy is left alone, it is not a count of events.
+void ofxWebcamZones::resetCounts()
+{
+  for(size_t i=0; i<zones.size(); i++)
+  {
+    zones[i].entries = 0;
+    zones[i].exits = 0;
+  }
+  for(size_t i=0; i<tripwires.size(); i++)
+  {
+    tripwires[i].forward = 0;
+    tripwires[i].backward = 0;
+  }
+}
+
+bool ofxWebcamZones::empty()
+{
+  return zones.empty() && tripwires.empty();
+}
+
+int ofxWebcamZones::findZoneIndex(int id)
+{
+  for(size_t i=0; i<zones.size(); i++)
+  {
+    if(zones[i].id == id) return i;
+  }
+  return -1;
+}
+
+int ofxWebcamZones::findTripwireIndex(int id)
+{
+  for(size_t i=0; i<tripwires.size(); i++)
+  {
+    if(tripwires[i].id == id) return i;
+  }
+  return -1;
+}
+
+ofxWebcamZone * ofxWebcamZones::getZone(int id)
+{
+  int index = findZoneIndex(id);
+  return index == -1 ? NULL : &zones[index];
+}
+
+ofxWebcamTripwire * ofxWebcamZones::getTripwire(int id)
+{
+  int index = findTripwireIndex(id);
+  return index == -1 ? NULL : &tripwires[index];
+}
+
+vector<ofxWebcamZone> & ofxWebcamZones::getZones()
+{
+  return zones;
+}
+
+vector<ofxWebcamTripwire> & ofxWebcamZones::getTripwires()
+{
+  return tripwires;
+}
+
+//Ids of the zones a blob is in.
+vector<int> ofxWebcamZones::getZonesOf(int blobId)
+{
+  vector<int> ids;
+  auto it = tracks.find(blobId);
+  if(it != tracks.end())
+  {
+    for(size_t i=0; i<it->second.inside.size(); i++)
+    {
+      ids.push_back(zones[it->second.inside[i]].id);
+    }
+  }
+  return ids;
+}
+
+//Lists every item in each cell its bounds touch, with a counting sort.
+void ofxWebcamZones::index(vector<int> & start, vector<int> & cells, const vector<ofRectangle> & bounds)
+{
+  start.assign(cols * rows + 1, 0);
+  for(int pass=0; pass<2; pass++)
+  {
+    for(size_t i=0; i<bounds.size(); i++)
+    {
+      int x0 = cellX(bounds[i].getLeft());
+      int x1 = cellX(bounds[i].getRight());
+      int y0 = cellY(bounds[i].getTop());
+      int y1 = cellY(bounds[i].getBottom());
+      for(int cy=y0; cy<=y1; cy++)
+      {
+        for(int cx=x0; cx<=x1; cx++)
+        {
+          int c = cy * cols + cx;
+          if(pass == 0) start[c + 1]++;
+          else cells[start[c]++] = i;
+        }
+      }
+    }
+    if(pass == 0)
+    {
+      for(int c=0; c<cols * rows; c++)
+      {
+        start[c + 1] += start[c];
+      }
+      cells.resize(start[cols * rows]);
+    }
+  }
+  //The fill advanced every start to the next cell's start, shift back.
+  for(int c=cols * rows; c>0; c--)
+  {
+    start[c] = start[c - 1];
+  }
+  start[0] = 0;
+}
+
+void ofxWebcamZones::rebuild()
+{
+  cols = MAX(1, (imageWidth + cellSize - 1) / cellSize);
+  rows = MAX(1, (imageHeight + cellSize - 1) / cellSize);
+
+  vector<ofRectangle> bounds(zones.size());
+  for(size_t i=0; i<zones.size(); i++)
+  {
+    bounds[i] = zones[i].bounds;
+  }
+  index(zoneStart, zoneCells, bounds);
+
+  bounds.resize(tripwires.size());
+  for(size_t i=0; i<tripwires.size(); i++)
+  {
+    ofVec2f & a = tripwires[i].a;
+    ofVec2f & b = tripwires[i].b;
+    bounds[i].set(MIN(a.x, b.x), MIN(a.y, b.y), fabs(b.x - a.x), fabs(b.y - a.y));
+  }
+  index(wireStart, wireCells, bounds);
+  wireStamp.assign(tripwires.size(), stamp);
+
+  dirty = false;
+}
+
+//Crossing number test, points on the edge may go either way.
+bool ofxWebcamZones::contains(const ofxWebcamZone & zone, const ofVec2f & p)
+{
+  if(!zone.bounds.inside(p.x, p.y)) return false;
+
+  bool in = false;
+  const vector<ofVec2f> & pts = zone.points;
+  for(size_t i=0, j=pts.size() - 1; i<pts.size(); j=i++)
+  {
+    if((pts[i].y > p.y) != (pts[j].y > p.y) &&
+       p.x < pts[j].x + (pts[i].x - pts[j].x) * (p.y - pts[j].y) / (pts[i].y - pts[j].y))
+    {
+      in = !in;
+    }
+  }
+  return in;
+}
+
+//Indices of the zones containing p, in index order.
+void ofxWebcamZones::findZones(const ofVec2f & p, vector<int> & out)
+{
+  out.clear();
+  int c = cellY(p.y) * cols + cellX(p.x);
+  for(int e=zoneStart[c]; e<zoneStart[c + 1]; e++)
+  {
+    if(contains(zones[zoneCells[e]], p)) out.push_back(zoneCells[e]);
+  }
+}
+
+//Tests the step from -> to against the tripwires in the cells it covers.
+//A point exactly on a line counts as being on its right.
+void ofxWebcamZones::crossTripwires(int id, const ofVec2f & from, const ofVec2f & to, float now, int frameNumber, vector<ofxWebcamZoneEvent> & events)
+{
+  if(tripwires.empty()) return;
+
+  stamp++;
+  int x0 = cellX(MIN(from.x, to.x));
+  int x1 = cellX(MAX(from.x, to.x));
+  int y0 = cellY(MIN(from.y, to.y));
+  int y1 = cellY(MAX(from.y, to.y));
+  for(int cy=y0; cy<=y1; cy++)
+  {
+    for(int cx=x0; cx<=x1; cx++)
+    {
+      int c = cy * cols + cx;
+      for(int e=wireStart[c]; e<wireStart[c + 1]; e++)
+      {
+        int w = wireCells[e];
+        if(wireStamp[w] == stamp) continue;
+        wireStamp[w] = stamp;
+
+        ofxWebcamTripwire & wire = tripwires[w];
+        float s0 = sideOf(wire.a, wire.b, from);
+        float s1 = sideOf(wire.a, wire.b, to);
+        if((s0 < 0) == (s1 < 0)) continue;
+        float t0 = sideOf(from, to, wire.a);
+        float t1 = sideOf(from, to, wire.b);
+        if((t0 < 0) == (t1 < 0)) continue;
+
+        int direction = s1 < 0 ? 1 : -1;
+        if(direction > 0) wire.forward++;
+        else wire.backward++;
+        emit(events, OFX_WEBCAM_TRIPWIRE_CROSSED, wire.id, id, direction, to, now, frameNumber);
+      }
+    }
+  }
+}
+
+void ofxWebcamZones::emit(vector<ofxWebcamZoneEvent> & events, ofxWebcamZoneEventType type, int zone, int id, int direction, const ofVec2f & p, float now, int frameNumber)
+{
+  ofxWebcamZoneEvent event;
+  event.type = type;
+  event.zone = zone;
+  event.id = id;
+  event.direction = direction;
+  event.position = ofPoint(p.x, p.y);
+  event.time = now;
+  event.frame = frameNumber;
+  events.push_back(event);
+}
+
+//Appends this frame's entries, exits and crossings to events. Only blobs
+//that are new or moved are evaluated, and all of them after the zones changed.
+void ofxWebcamZones::update(vector<ofxWebcamBlob> & blobs, float now, int frameNumber, vector<ofxWebcamZoneEvent> & events)
+{
+  uint64_t start = ofGetElapsedTimeMicros();
+  evaluated = 0;
+  if(empty())
+  {
+    tracks.clear();
+    time = 0;
+    return;
+  }
+
+  bool all = dirty;
+  if(dirty)
+  {
+    rebuild();
+  }
+
+  generation++;
+  for(size_t i=0; i<blobs.size(); i++)
+  {
+    ofxWebcamBlob & blob = blobs[i];
+    ofVec2f p(blob.blob.centroid.x, blob.blob.centroid.y);
+
+    auto it = tracks.find(blob.id);
+    if(it == tracks.end())
+    {
+      Track & track = tracks[blob.id];
+      track.position = p;
+      track.seen = generation;
+      findZones(p, track.inside);
+      for(size_t z=0; z<track.inside.size(); z++)
+      {
+        ofxWebcamZone & zone = zones[track.inside[z]];
+        zone.occupancy++;
+        zone.entries++;
+        emit(events, OFX_WEBCAM_ZONE_ENTERED, zone.id, blob.id, 0, p, now, frameNumber);
+      }
+      evaluated++;
+      continue;
+    }
+
+    Track & track = it->second;
+    track.seen = generation;
+    if(!blob.isActive() || (!all && track.position.x == p.x && track.position.y == p.y))
+    {
+      continue;
+    }
+    evaluated++;
+
+    crossTripwires(blob.id, track.position, p, now, frameNumber, events);
+
+    //Both lists are short and sorted, walk them together.
+    findZones(p, found);
+    size_t a = 0;
+    size_t b = 0;
+    while(a < track.inside.size() || b < found.size())
+    {
+      if(b == found.size() || (a < track.inside.size() && track.inside[a] < found[b]))
+      {
+        ofxWebcamZone & zone = zones[track.inside[a++]];
+        zone.occupancy--;
+        zone.exits++;
+        emit(events, OFX_WEBCAM_ZONE_EXITED, zone.id, blob.id, 0, p, now, frameNumber);
+      }
+      else if(a == track.inside.size() || found[b] < track.inside[a])
+      {
+        ofxWebcamZone & zone = zones[found[b++]];
+        zone.occupancy++;
+        zone.entries++;
+        emit(events, OFX_WEBCAM_ZONE_ENTERED, zone.id, blob.id, 0, p, now, frameNumber);
+      }
+      else
+      {
+        a++;
+        b++;
+      }
+    }
+    track.inside.swap(found);
+    track.position = p;
+  }
+
+  //Blobs that were removed leave their zones.
+  for(auto it = tracks.begin(); it != tracks.end(); )
+  {
+    Track & track = it->second;
+    if(track.seen == generation)
+    {
+      ++it;
+      continue;
+    }
+    for(size_t z=0; z<track.inside.size(); z++)
+    {
+      ofxWebcamZone & zone = zones[track.inside[z]];
+      zone.occupancy--;
+      zone.exits++;
+      emit(events, OFX_WEBCAM_ZONE_EXITED, zone.id, it->first, 0, track.position, now, frameNumber);
+    }
+    it = tracks.erase(it);
+  }
+
+  time = (ofGetElapsedTimeMicros() - start) / 1000.0f;
+}
+
+//Blobs looked at in the last update.
+int ofxWebcamZones::getEvaluated()
+{
+  return evaluated;
+}
+
+//Milliseconds the last update took.
+float ofxWebcamZones::getTime()
+{
+  return time;
+}
@@ -0,0 +1,121 @@
+#pragma once
+#include "ofMain.h"
+#include "ofxWebcamBlob.h"
+#include <unordered_map>
+
+#define DEFAULT_ZONE_CELL_SIZE 32
+
+enum ofxWebcamZoneEventType {
+  OFX_WEBCAM_ZONE_ENTERED = 0,
+  OFX_WEBCAM_ZONE_EXITED,
+  OFX_WEBCAM_TRIPWIRE_CROSSED
+};
+
+struct ofxWebcamZoneEvent {
+  ofxWebcamZoneEventType type;
+  int zone;       //Zone or tripwire id
+  int id;         //Blob id
+  int direction;  //Tripwires only: 1 forward, -1 backward
+  ofPoint position;
+  float time;
+  int frame;
+};
+
+//An area to count people in. Points are in tracker pixels, in order,
+//and the polygon is closed implicitly.
+struct ofxWebcamZone {
+  int id;
+  string name;
+  vector<ofVec2f> points;
+  ofRectangle bounds;
+  int occupancy;  //Blobs inside right now
+  int entries;
+  int exits;
+};
+
+//A line to count crossings of. Forward is from the right of a->b to its
+//left as seen on screen (y down), so a line drawn left to right counts
+//upward movement as forward.
+struct ofxWebcamTripwire {
+  int id;
+  string name;
+  ofVec2f a;
+  ofVec2f b;
+  int forward;
+  int backward;
+};
+
+//Counts blobs going in and out of zones and across tripwires. Zones and
+//tripwires are indexed in a uniform grid, so a blob is only tested against
+//the few whose bounds touch the cells it is in or moved through, however
+//many there are. Blobs that did not move since the last frame are not
+//looked at again. A lost blob stays in its zones until it is removed.
+class ofxWebcamZones {
+  private:
+    struct Track {
+      ofVec2f position;
+      vector<int> inside;  //Zone indices
+      int seen;
+    };
+
+    vector<ofxWebcamZone> zones;
+    vector<ofxWebcamTripwire> tripwires;
+    unordered_map<int, Track> tracks;
+    int nextId;
+
+    //Grid, rebuilt when zones or tripwires change
+    int imageWidth;
+    int imageHeight;
+    int cellSize;
+    int cols;
+    int rows;
+    bool dirty;
+    vector<int> zoneStart;
+    vector<int> zoneCells;
+    vector<int> wireStart;
+    vector<int> wireCells;
+    vector<int> wireStamp;
+    int stamp;
+
+    int generation;
+    int evaluated;
+    float time;
+    vector<int> found;
+
+    int cellX(float x);
+    int cellY(float y);
+    void rebuild();
+    void index(vector<int> & start, vector<int> & cells, const vector<ofRectangle> & bounds);
+    bool contains(const ofxWebcamZone & zone, const ofVec2f & p);
+    void findZones(const ofVec2f & p, vector<int> & out);
+    void crossTripwires(int id, const ofVec2f & from, const ofVec2f & to, float now, int frameNumber, vector<ofxWebcamZoneEvent> & events);
+    void emit(vector<ofxWebcamZoneEvent> & events, ofxWebcamZoneEventType type, int zone, int id, int direction, const ofVec2f & p, float now, int frameNumber);
+    int findZoneIndex(int id);
+    int findTripwireIndex(int id);
+
+  public:
+    ofxWebcamZones();
+    ~ofxWebcamZones();
+
+    void setup(int width, int height, int cellSize=DEFAULT_ZONE_CELL_SIZE);
+    int getCellSize();
+
+    int addZone(const vector<ofVec2f> & points, string name="");
+    int addZone(const ofRectangle & rect, string name="");
+    int addTripwire(const ofVec2f & a, const ofVec2f & b, string name="");
+    void removeZone(int id);
+    void removeTripwire(int id);
+    void clear();
+    void resetCounts();
+    bool empty();
+
+    ofxWebcamZone * getZone(int id);
+    ofxWebcamTripwire * getTripwire(int id);
+    vector<ofxWebcamZone> & getZones();
+    vector<ofxWebcamTripwire> & getTripwires();
+    vector<int> getZonesOf(int blobId);
+
+    void update(vector<ofxWebcamBlob> & blobs, float now, int frameNumber, vector<ofxWebcamZoneEvent> & events);
+    int getEvaluated();
+    float getTime();
+};